@@ -1,48 +1,35 @@
-QT       += core gui serialport
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-CONFIG += c++11
-
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    main.cpp \
-    mode.cpp \
-    protocol.cpp \
-    receive.cpp \
-    send.cpp \
-    widget.cpp
-
-HEADERS += \
-    protocol.h \
-    widget.h
-
-FORMS += \
-    widget.ui
-
-RC_ICONS = icons/Elevator.ico
-
-TRANSLATIONS += \
-    Elevator_control_platform_zh_CN.ts
-CONFIG += lrelease
-CONFIG += embed_translations
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-DISTFILES += \
-    icons/Elevator.ico \
-    icons/down.png \
-    icons/power_black.png \
-    icons/power_green.png \
-    icons/power_red.png \
-    icons/stop.png \
-    icons/up.png
-
-RESOURCES += \
-    resource.qrc
+TEMPLATE = subdirs
+
+# core:   协议核心静态库（纯 C++）
+# app:    升降器控制平台界面程序
+# replay: 抓包回放命令行工具
+# bench:  协议核心微基准测试
+# simulator: 下位机模拟器（仅 Linux，基于伪终端）
+# fleet:  多串口压力工具（仅 Linux，基于 epoll 反应器）
+# coretest: 协议核心单元测试（make check 时运行）
+SUBDIRS += \
+    core \
+    app \
+    replay \
+    bench \
+    coretest
+
+linux: SUBDIRS += simulator fleet
+
+app.file = app.pro
+app.depends = core
+
+replay.subdir = tools/replay
+replay.depends = core
+
+bench.subdir = tools/bench
+bench.depends = core
+
+simulator.subdir = tools/simulator
+simulator.depends = core
+
+fleet.subdir = tools/fleet
+fleet.depends = core
+
+coretest.subdir = tests/coretest
+coretest.depends = core
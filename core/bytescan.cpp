@@ -0,0 +1,255 @@
+#include "bytescan.h"
+
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BYTESCAN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(BYTESCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+static const uint8_t SYNC_HIGH = 0x55;
+static const uint8_t SYNC_LOW = 0xAA;
+
+static size_t findSyncWordScalar(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i + 1 < len; ++i) {
+        if (data[i] == SYNC_HIGH && data[i + 1] == SYNC_LOW) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static uint8_t checksum8Scalar(const uint8_t *data, size_t len)
+{
+    uint8_t sum = 0x00;
+    for (size_t i = 0; i < len; ++i) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+#ifdef BYTESCAN_X86
+
+static inline unsigned lowestBit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// 每次比较 16 字节：data[i] == 0x55 且 data[i + 1] == 0xAA
+TARGET_SSE2 static size_t findSyncWordSSE2(const uint8_t *data, size_t len)
+{
+    const __m128i high = _mm_set1_epi8(static_cast<char>(SYNC_HIGH));
+    const __m128i low = _mm_set1_epi8(static_cast<char>(SYNC_LOW));
+    size_t i = 0;
+    for (; i + 17 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, high), _mm_cmpeq_epi8(b, low))));
+        if (mask) {
+            return i + lowestBit(mask);
+        }
+    }
+    size_t tail = findSyncWordScalar(data + i, len - i);
+    return i + tail;
+}
+
+// _mm_sad_epu8 对每 8 个字节求和，累加到两个 64 位通道
+TARGET_SSE2 static uint8_t checksum8SSE2(const uint8_t *data, size_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    uint32_t sum = static_cast<uint32_t>(_mm_cvtsi128_si32(acc))
+                   + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+    return static_cast<uint8_t>(sum + checksum8Scalar(data + i, len - i));
+}
+
+TARGET_AVX2 static size_t findSyncWordAVX2(const uint8_t *data, size_t len)
+{
+    const __m256i high = _mm256_set1_epi8(static_cast<char>(SYNC_HIGH));
+    const __m256i low = _mm256_set1_epi8(static_cast<char>(SYNC_LOW));
+    size_t i = 0;
+    for (; i + 33 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, high), _mm256_cmpeq_epi8(b, low))));
+        if (mask) {
+            return i + lowestBit(mask);
+        }
+    }
+    // 不足 32 字节的尾部在本函数内处理：调用非 VEX 编码的 SSE2 函数会产生 AVX/SSE 切换停顿
+    if (i + 17 <= len) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+        __m128i match = _mm_and_si128(_mm_cmpeq_epi8(a, _mm256_castsi256_si128(high)),
+                                      _mm_cmpeq_epi8(b, _mm256_castsi256_si128(low)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+        if (mask) {
+            return i + lowestBit(mask);
+        }
+        i += 16;
+    }
+    size_t tail = findSyncWordScalar(data + i, len - i);
+    return i + tail;
+}
+
+TARGET_AVX2 static uint8_t checksum8AVX2(const uint8_t *data, size_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    if (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        half = _mm_add_epi64(half, _mm_sad_epu8(v, _mm_setzero_si128()));
+        i += 16;
+    }
+    uint32_t sum = static_cast<uint32_t>(_mm_cvtsi128_si32(half))
+                   + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(half, 8)));
+    return static_cast<uint8_t>(sum + checksum8Scalar(data + i, len - i));
+}
+
+static bool cpuSupports(SimdLevel level)
+{
+    if (level == SimdLevel::Scalar) {
+        return true;
+    }
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    if (level == SimdLevel::SSE2) {
+        return sse2;
+    }
+    // AVX2 还需要操作系统保存 YMM 寄存器
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    if (level == SimdLevel::SSE2) {
+        return __builtin_cpu_supports("sse2");
+    }
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#else
+
+static bool cpuSupports(SimdLevel level)
+{
+    return level == SimdLevel::Scalar;
+}
+
+#endif // BYTESCAN_X86
+
+using FindSyncWordFn = size_t (*)(const uint8_t *, size_t);
+using Checksum8Fn = uint8_t (*)(const uint8_t *, size_t);
+
+struct Kernels {
+    SimdLevel level;
+    FindSyncWordFn findSyncWord;
+    Checksum8Fn checksum8;
+};
+
+static Kernels kernelsFor(SimdLevel level)
+{
+    switch (level) {
+#ifdef BYTESCAN_X86
+        case SimdLevel::AVX2:
+            return {SimdLevel::AVX2, findSyncWordAVX2, checksum8AVX2};
+        case SimdLevel::SSE2:
+            return {SimdLevel::SSE2, findSyncWordSSE2, checksum8SSE2};
+#endif
+        default:
+            return {SimdLevel::Scalar, findSyncWordScalar, checksum8Scalar};
+    }
+}
+
+// 首次调用时选择 CPU 支持的最快实现
+static Kernels &activeKernels()
+{
+    static Kernels kernels = kernelsFor(cpuSupports(SimdLevel::AVX2) ? SimdLevel::AVX2
+                                        : cpuSupports(SimdLevel::SSE2) ? SimdLevel::SSE2
+                                                                       : SimdLevel::Scalar);
+    return kernels;
+}
+
+SimdLevel simdLevel()
+{
+    return activeKernels().level;
+}
+
+const char *simdLevelName(SimdLevel level)
+{
+    switch (level) {
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
+
+bool simdLevelFromName(const char *name, SimdLevel &level)
+{
+    for (SimdLevel candidate : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (std::strcmp(name, simdLevelName(candidate)) == 0) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool setSimdLevel(SimdLevel level)
+{
+    if (!cpuSupports(level)) {
+        return false;
+    }
+    activeKernels() = kernelsFor(level);
+    return true;
+}
+
+size_t findSyncWord(const uint8_t *data, size_t len)
+{
+    return activeKernels().findSyncWord(data, len);
+}
+
+uint8_t checksum8(const uint8_t *data, size_t len)
+{
+    return activeKernels().checksum8(data, len);
+}
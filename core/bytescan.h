@@ -0,0 +1,29 @@
+#ifndef BYTESCAN_H
+#define BYTESCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 字节流扫描内核：帧头查找与 8 位累加校验和
+// x86 上按 CPU 支持情况在 AVX2 / SSE2 / 标量实现之间运行时选择，其他平台使用标量实现
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// 当前使用的实现
+SimdLevel simdLevel();
+const char *simdLevelName(SimdLevel level);
+bool simdLevelFromName(const char *name, SimdLevel &level);
+
+// 强制使用指定实现（基准测试、对比验证用），须在开始解析之前调用；CPU 不支持时返回 false 且不切换
+bool setSimdLevel(SimdLevel level);
+
+// 查找帧头 55 AA，返回 0x55 的位置；找不到返回 len
+size_t findSyncWord(const uint8_t *data, size_t len);
+
+// 8位累加校验和（对256取余）
+uint8_t checksum8(const uint8_t *data, size_t len);
+
+#endif // BYTESCAN_H
@@ -0,0 +1,260 @@
+#include "capture.h"
+#include "fileutil.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char CAPTUREMAGIC[8] = {'E', 'L', 'V', 'C', 'A', 'P', '0', '1'};
+
+static void putLE(uint8_t *out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint64_t getLE(const uint8_t *in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const std::string &path)
+{
+    std::lock_guard<std::mutex> locker(mutex);
+    if (file) {
+        std::fclose(file);
+    }
+
+    file = fopenUtf8(path, "wb");
+    if (!file) {
+        return false;
+    }
+
+    start = std::chrono::steady_clock::now();
+    uint64_t wallClockNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    uint8_t header[CAPTUREFILEHEADERSIZE] = {};
+    std::memcpy(header, CAPTUREMAGIC, sizeof(CAPTUREMAGIC));
+    putLE(header + 8, CAPTUREVERSION, 2);
+    putLE(header + 10, CAPTUREFILEHEADERSIZE, 2);
+    putLE(header + 16, wallClockNs, 8);
+    std::fwrite(header, 1, sizeof(header), file);
+    std::fflush(file);
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    std::lock_guard<std::mutex> locker(mutex);
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void CaptureWriter::append(CaptureDirection direction, uint8_t portId, const uint8_t *data, size_t len)
+{
+    std::lock_guard<std::mutex> locker(mutex);
+    if (!file) {
+        return;
+    }
+
+    uint64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // 记录头和数据合并为一次写入
+    record.resize(CAPTURERECORDHEADERSIZE + len);
+    putLE(&record[0], timestampNs, 8);
+    putLE(&record[8], len, 4);
+    record[12] = static_cast<uint8_t>(direction);
+    record[13] = portId;
+    putLE(&record[14], CAPTURERECORDMARKER, 2);
+    if (len > 0) {
+        std::memcpy(&record[CAPTURERECORDHEADERSIZE], data, len);
+    }
+
+    std::fwrite(record.data(), 1, record.size(), file);
+    std::fflush(file);
+}
+
+
+CaptureReader::~CaptureReader()
+{
+    close();
+}
+
+bool CaptureReader::open(const std::string &path)
+{
+    close();
+    if (!map(path)) {
+        return false;
+    }
+
+    if (size < CAPTUREFILEHEADERSIZE || std::memcmp(base, CAPTUREMAGIC, sizeof(CAPTUREMAGIC)) != 0) {
+        error = "not a capture file";
+        close();
+        return false;
+    }
+    if (getLE(base + 8, 2) != CAPTUREVERSION) {
+        error = "unsupported capture version";
+        close();
+        return false;
+    }
+
+    size_t headerSize = getLE(base + 10, 2);
+    if (headerSize < CAPTUREFILEHEADERSIZE || headerSize > size) {
+        error = "invalid capture header size";
+        close();
+        return false;
+    }
+    startTime = getLE(base + 16, 8);
+
+    // 建立记录索引，遇到不完整或损坏的记录即停止
+    size_t pos = headerSize;
+    while (pos + CAPTURERECORDHEADERSIZE <= size) {
+        size_t length = getLE(base + pos + 8, 4);
+        if (getLE(base + pos + 14, 2) != CAPTURERECORDMARKER
+            || length > size - pos - CAPTURERECORDHEADERSIZE) {
+            break;
+        }
+        offsets.push_back(pos);
+        pos += CAPTURERECORDHEADERSIZE + length;
+    }
+    tailTruncated = pos != size;
+    return true;
+}
+
+void CaptureReader::close()
+{
+    unmap();
+    offsets.clear();
+    startTime = 0;
+    tailTruncated = false;
+}
+
+CaptureRecord CaptureReader::record(size_t index) const
+{
+    const uint8_t *p = base + offsets[index];
+    CaptureRecord rec;
+    rec.timestampNs = getLE(p, 8);
+    rec.length = getLE(p + 8, 4);
+    rec.direction = static_cast<CaptureDirection>(p[12]);
+    rec.portId = p[13];
+    rec.data = p + CAPTURERECORDHEADERSIZE;
+    return rec;
+}
+
+#ifdef _WIN32
+
+bool CaptureReader::map(const std::string &path)
+{
+    HANDLE handle = CreateFileW(toWidePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "cannot open file";
+        return false;
+    }
+    fileHandle = handle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        error = "empty file";
+        unmap();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    mappingHandle = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        error = "cannot map file";
+        unmap();
+        return false;
+    }
+    base = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!base) {
+        error = "cannot map file";
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+void CaptureReader::unmap()
+{
+    if (base) {
+        UnmapViewOfFile(base);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    base = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    size = 0;
+}
+
+#else
+
+bool CaptureReader::map(const std::string &path)
+{
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open file";
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        error = "empty file";
+        unmap();
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        error = "cannot map file";
+        size = 0;
+        unmap();
+        return false;
+    }
+    base = static_cast<const uint8_t *>(addr);
+    return true;
+}
+
+void CaptureReader::unmap()
+{
+    if (base) {
+        munmap(const_cast<uint8_t *>(base), size);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    base = nullptr;
+    fd = -1;
+    size = 0;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 串口收发抓包文件格式（所有整数均为小端）
+//
+// 文件头 24 字节：
+//   char     magic[8]       "ELVCAP01"
+//   uint16   version        CAPTUREVERSION
+//   uint16   headerSize     文件头长度
+//   uint32   reserved
+//   uint64   startTimeNs    开始抓包时的系统时间（Unix 纳秒）
+//
+// 记录，每条 16 字节头 + 原始字节：
+//   uint64   timestampNs    相对开始抓包的单调时钟时间（纳秒）
+//   uint32   length         原始字节数
+//   uint8    direction      CaptureDirection
+//   uint8    portId         端口编号
+//   uint16   marker         CAPTURERECORDMARKER，用于校验记录头
+//   uint8    data[length]
+//
+// 只追加写入，每条记录一次写入并 fflush，进程崩溃最多丢失最后一条不完整的记录；
+// 读取时遇到越界或标记不符的记录即视为文件结束
+#define CAPTUREVERSION          1
+#define CAPTUREFILEHEADERSIZE   24
+#define CAPTURERECORDHEADERSIZE 16
+#define CAPTURERECORDMARKER     0xA55A
+
+enum class CaptureDirection : uint8_t {
+    TX = 0,
+    RX = 1
+};
+
+// 抓包写入
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // 追加一条记录，可在多个线程中调用
+    void append(CaptureDirection direction, uint8_t portId, const uint8_t *data, size_t len);
+
+private:
+    std::mutex mutex;
+    std::FILE *file = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::vector<uint8_t> record;   // 复用的记录缓冲
+};
+
+// 一条抓包记录，data 指向映射的文件内容
+struct CaptureRecord {
+    uint64_t timestampNs;
+    CaptureDirection direction;
+    uint8_t portId;
+    const uint8_t *data;
+    size_t length;
+};
+
+// 抓包读取：内存映射整个文件，打开时建立记录索引，支持随机访问
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader &) = delete;
+    CaptureReader &operator=(const CaptureReader &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    size_t recordCount() const { return offsets.size(); }
+    CaptureRecord record(size_t index) const;
+
+    uint64_t startTimeNs() const { return startTime; }
+    bool truncated() const { return tailTruncated; }   // 末尾存在不完整的记录
+    const std::string &errorString() const { return error; }
+
+private:
+    bool map(const std::string &path);
+    void unmap();
+
+    const uint8_t *base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    std::vector<size_t> offsets;   // 每条记录头在文件中的偏移
+    uint64_t startTime = 0;
+    bool tailTruncated = false;
+    std::string error;
+};
+
+#endif // CAPTURE_H
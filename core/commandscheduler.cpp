@@ -0,0 +1,311 @@
+#include "commandscheduler.h"
+#include "protocol.h"
+
+#include <algorithm>
+#include <iterator>
+
+CommandScheduler::CommandScheduler()
+    : window(SENDWINDOWSIZE),
+    timeout(std::chrono::milliseconds(RESPONSETIMEOUTTIMESET)),
+    maxAttempts(SENDMAXATTEMPTS) {
+}
+
+void CommandScheduler::setWindowSize(size_t size)
+{
+    window = size < 1 ? 1 : size;
+}
+
+uint64_t CommandScheduler::enqueue(std::vector<uint8_t> frame, const std::string &label, uint32_t tag,
+                                   CommandPriority priority, uint32_t group)
+{
+    size_t laneIndex = static_cast<size_t>(priority);
+
+    if (priority == CommandPriority::Safety && frame.size() > 6 && frame[3] == DEVICE_CONTROL) {
+        supersede(frame[6]);
+    } else if (uint32_t mask = fieldMask(frame)) {
+        bool composite = findDP(frame[6])->fields != nullptr;
+        for (size_t i = 0; i < COMMANDPRIORITYCOUNT; ++i) {
+            for (auto it = lanes[i].begin(); it != lanes[i].end();) {
+                uint32_t queuedMask = fieldMask(it->frame);
+                if ((queuedMask & mask) == 0) {
+                    ++it;
+                    continue;
+                }
+                // 写入的状态全部被新指令覆盖：旧值不再发送，报告为取消
+                bool covered = (queuedMask & ~mask) == 0
+                               && (isLatestWins(it->frame) || (composite && findDP(it->frame[6])->fields));
+                if (covered) {
+                    cancelled.push_back({SchedulerEvent::Cancelled, std::move(*it)});
+                    it = lanes[i].erase(it);
+                    ++coalesced;
+                    continue;
+                }
+                // 部分重叠：新指令排在旧指令所在通道之后
+                laneIndex = std::max(laneIndex, i);
+                ++it;
+            }
+        }
+    }
+
+    std::deque<ScheduledCommand> &lane = lanes[laneIndex];
+    ScheduledCommand command;
+    command.id = nextId++;
+    command.expect = expectedResponse(frame);
+    command.priority = priority;
+    command.frame = std::move(frame);
+    command.label = label;
+    command.tag = tag;
+    command.group = group;
+    lane.push_back(std::move(command));
+    return lane.back().id;
+}
+
+// 取消排队和在途的、写同一 DP 的旧指令，在途的旧指令不再重发
+void CommandScheduler::supersede(uint8_t dpId)
+{
+    for (auto &lane : lanes) {
+        for (auto it = lane.begin(); it != lane.end();) {
+            if (writesDP(it->frame, dpId)) {
+                cancelled.push_back({SchedulerEvent::Cancelled, std::move(*it)});
+                it = lane.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto it = inFlight.begin(); it != inFlight.end();) {
+        if (writesDP(it->frame, dpId)) {
+            // 旧指令已经发出，下位机仍会响应：留下墓碑吸收这一帧响应
+            superseded.push_back(*it);
+            cancelled.push_back({SchedulerEvent::Cancelled, std::move(*it)});
+            it = inFlight.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t CommandScheduler::cancelGroup(uint32_t group)
+{
+    size_t count = 0;
+    for (auto &lane : lanes) {
+        for (auto it = lane.begin(); it != lane.end();) {
+            if (it->group == group) {
+                cancelled.push_back({SchedulerEvent::Cancelled, std::move(*it)});
+                it = lane.erase(it);
+                ++count;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return count;
+}
+
+size_t CommandScheduler::queuedCount() const
+{
+    size_t count = 0;
+    for (const auto &lane : lanes) {
+        count += lane.size();
+    }
+    return count;
+}
+
+ResponseKey CommandScheduler::expectedResponse(const std::vector<uint8_t> &frame)
+{
+    if (frame.size() < 7) {
+        return {MCU_RESPONSE, -1};
+    }
+
+    switch (frame[3]) {
+        case HEARTBEAT:
+            return {HEARTBEAT, -1};
+        case QUERY_STATUS:
+            return {MCU_RESPONSE, static_cast<int>(DPType::ALL_STATUS)};
+        case DEVICE_CONTROL:
+            // 数据区第一个字节为 DP ID
+            return {MCU_RESPONSE, frame.size() > 7 ? frame[6] : -1};
+        default:
+            return {MCU_RESPONSE, -1};
+    }
+}
+
+bool CommandScheduler::isLatestWins(const std::vector<uint8_t> &frame)
+{
+    if (frame.size() <= 6 || frame[3] != DEVICE_CONTROL) {
+        return false;
+    }
+    const DPDescriptor *dp = findDP(frame[6]);
+    return dp && dp->latestWins;
+}
+
+bool CommandScheduler::writesDP(const std::vector<uint8_t> &frame, uint8_t dpId)
+{
+    if (frame.size() <= 6 || frame[3] != DEVICE_CONTROL) {
+        return false;
+    }
+    if (frame[6] == dpId) {
+        return true;
+    }
+
+    // 复合 DP 写入其全部组成
+    const DPDescriptor *dp = findDP(frame[6]);
+    if (dp) {
+        for (size_t i = 0; i < dp->fieldCount; ++i) {
+            if (static_cast<uint8_t>(dp->fields[i].id) == dpId) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t CommandScheduler::fieldMask(const std::vector<uint8_t> &frame)
+{
+    if (frame.size() <= 6 || frame[3] != DEVICE_CONTROL) {
+        return 0;
+    }
+    uint32_t mask = 0;
+    for (size_t i = 0; i < std::size(ALL_STATUS_FIELDS); ++i) {
+        if (writesDP(frame, static_cast<uint8_t>(ALL_STATUS_FIELDS[i].id))) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+// 期望相同响应的请求不能同时在途，否则无法区分响应归属；
+// 写同一状态的请求也不同时在途，避免旧指令重发时覆盖新值
+bool CommandScheduler::blocked(const ScheduledCommand &command) const
+{
+    const ResponseKey &key = command.expect;
+    uint32_t mask = fieldMask(command.frame);
+    for (const auto &other : inFlight) {
+        if (other.expect.command == key.command
+            && (other.expect.dpId == key.dpId || other.expect.dpId < 0 || key.dpId < 0)) {
+            return true;
+        }
+        if (mask & fieldMask(other.frame)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CommandScheduler::fillWindow(Clock::time_point now, std::vector<SchedulerEvent> &events)
+{
+    // 先取高优先级通道，通道内按队列顺序发送；安全通道不受发送窗口限制
+    // 高优先级通道中仍在排队的指令所写的状态，低优先级通道的指令不能先发（写同一状态的新指令总在较低通道）
+    uint32_t queuedMask = 0;
+    for (auto &lane : lanes) {
+        bool safety = &lane == &lanes[static_cast<size_t>(CommandPriority::Safety)];
+        while (!lane.empty() && (safety || inFlight.size() < window) && !blocked(lane.front())
+               && (fieldMask(lane.front().frame) & queuedMask) == 0) {
+            ScheduledCommand command = std::move(lane.front());
+            lane.pop_front();
+            command.attempts = 1;
+            command.deadline = now + timeout;
+            inFlight.push_back(command);
+            events.push_back({SchedulerEvent::Transmit, std::move(command)});
+        }
+        for (const auto &command : lane) {
+            queuedMask |= fieldMask(command.frame);
+        }
+    }
+}
+
+void CommandScheduler::poll(Clock::time_point now, std::vector<SchedulerEvent> &events)
+{
+    for (auto &event : cancelled) {
+        events.push_back(std::move(event));
+    }
+    cancelled.clear();
+
+    // 截止时刻前没有收到响应的墓碑不再等待
+    superseded.erase(std::remove_if(superseded.begin(), superseded.end(), [now](const ScheduledCommand &c) {
+        return c.deadline <= now;
+    }), superseded.end());
+
+    for (auto it = inFlight.begin(); it != inFlight.end();) {
+        if (it->deadline > now) {
+            ++it;
+            continue;
+        }
+
+        if (it->attempts < maxAttempts) {
+            ++it->attempts;
+            it->deadline = now + timeout;
+            events.push_back({SchedulerEvent::Retransmit, *it});
+            ++it;
+        } else {
+            events.push_back({SchedulerEvent::Failed, std::move(*it)});
+            it = inFlight.erase(it);
+        }
+    }
+
+    fillWindow(now, events);
+}
+
+bool CommandScheduler::onResponse(uint8_t command, const uint8_t *data, size_t len,
+                                  Clock::time_point now, std::vector<SchedulerEvent> &events)
+{
+    int dpId = (command == MCU_RESPONSE && len > 0) ? data[0] : -1;
+    auto exact = [&](const ScheduledCommand &c) {
+        return c.expect.command == command && (c.expect.dpId < 0 || c.expect.dpId == dpId);
+    };
+    auto anyControl = [](const ScheduledCommand &c) {
+        return c.expect.command == MCU_RESPONSE;
+    };
+    bool allStatus = dpId == static_cast<int>(DPType::ALL_STATUS);
+
+    // 被取代的在途请求先发出，其响应先于新指令的响应到达：由墓碑吸收，不能当作新指令（如 STOP）的确认
+    auto stale = std::find_if(superseded.begin(), superseded.end(), exact);
+
+    // 优先匹配 命令字 + DP ID 完全一致的最早请求
+    auto match = std::find_if(inFlight.begin(), inFlight.end(), exact);
+
+    // 下位机以 ALL_STATUS 上报全部状态时，视为对最早一条设备控制/查询的响应
+    if (stale == superseded.end() && match == inFlight.end() && allStatus) {
+        stale = std::find_if(superseded.begin(), superseded.end(), anyControl);
+        if (stale == superseded.end()) {
+            match = std::find_if(inFlight.begin(), inFlight.end(), anyControl);
+        }
+    }
+
+    if (stale != superseded.end()) {
+        superseded.erase(stale);
+        return true;
+    }
+    if (match == inFlight.end()) {
+        return false;  // 迟到或主动上报的帧
+    }
+
+    events.push_back({SchedulerEvent::Completed, std::move(*match)});
+    inFlight.erase(match);
+    fillWindow(now, events);
+    return true;
+}
+
+bool CommandScheduler::nextDeadline(Clock::time_point &deadline) const
+{
+    if (inFlight.empty()) {
+        return false;
+    }
+
+    deadline = inFlight.front().deadline;
+    for (const auto &command : inFlight) {
+        deadline = std::min(deadline, command.deadline);
+    }
+    return true;
+}
+
+void CommandScheduler::clear()
+{
+    for (auto &lane : lanes) {
+        lane.clear();
+    }
+    inFlight.clear();
+    cancelled.clear();
+    superseded.clear();
+}
@@ -0,0 +1,119 @@
+#ifndef COMMANDSCHEDULER_H
+#define COMMANDSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// 期望的响应：响应命令字 + DP ID（dpId < 0 表示不关心 DP）
+struct ResponseKey {
+    uint8_t command;
+    int dpId;
+};
+
+#define COMMANDPRIORITYCOUNT    3        // 发送通道数
+
+// 指令优先级（发送通道），数值越小越优先
+enum class CommandPriority : uint8_t {
+    Safety = 0,         // STOP、关机：插队发送，不受发送窗口限制，取代同一 DP 的旧指令
+    Interactive = 1,    // 面板操作
+    Background = 2      // 模式步骤、心跳、查询
+};
+
+// 调度中的一条指令
+struct ScheduledCommand {
+    uint64_t id = 0;
+    std::vector<uint8_t> frame;       // 序列化后的完整帧
+    std::string label;                // 日志描述（UTF-8）
+    uint32_t tag = 0;                 // 调用方自定义数据（如日志颜色）
+    uint32_t group = 0;               // 调用方定义的分组，0 表示不分组，同组排队中的指令可整体取消
+    ResponseKey expect = {0, -1};
+    CommandPriority priority = CommandPriority::Interactive;
+    int attempts = 0;                 // 已发送次数
+    std::chrono::steady_clock::time_point deadline;
+};
+
+// 调度器产生的事件，由串口适配层执行（写串口、输出日志）
+struct SchedulerEvent {
+    enum Type {
+        Transmit,       // 首次发送
+        Retransmit,     // 超时重发
+        Completed,      // 收到匹配的响应
+        Failed,         // 多次超时，放弃
+        Cancelled       // 被合并的新值或安全指令取代，或按分组取消，未发送或停止重发
+    };
+    Type type;
+    ScheduledCommand command;
+};
+
+// 窗口化的指令调度器
+// 最多 windowSize 条指令同时在途，每条指令独立计时、独立重试，
+// 响应按 命令字 + DP ID 与在途请求配对。不依赖 Qt，时间由调用方传入。
+// 指令按调用方指定的优先级进入三个通道，发送时先取高优先级通道。
+// 设备控制指令入队时，各通道中尚未发送、写入状态全部被新指令覆盖的旧指令被取消
+// （单个 DP 须在 DP 描述表中标记为 latestWins，ALL_STATUS 被新的 ALL_STATUS 覆盖）；
+// 与新指令部分重叠的旧指令保留，新指令排在其所在通道之后，写同一状态的指令不会互相超越。
+// 写同一状态的指令也不同时在途，旧指令重发时不会覆盖新值。
+// 安全指令入队时取消排队和在途的、写同一 DP 的旧指令（ALL_STATUS 视为写全部状态），
+// 且不占用发送窗口，因此 STOP 在下一次 poll 时即发出，延迟与队列深度无关。
+// 被取代的在途请求留下墓碑，吸收其截止时刻前到达的一帧响应，迟到的旧响应不会被当作安全指令的确认。
+class CommandScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CommandScheduler();
+
+    void setWindowSize(size_t size);
+    size_t windowSize() const { return window; }
+
+    // 返回指令编号
+    uint64_t enqueue(std::vector<uint8_t> frame, const std::string &label, uint32_t tag, CommandPriority priority,
+                     uint32_t group = 0);
+
+    // 取消 group 组中尚未发送的指令（下一次 poll 时报告），在途的指令照常等待响应，返回取消的条数
+    size_t cancelGroup(uint32_t group);
+
+    // 处理超时并填充发送窗口
+    void poll(Clock::time_point now, std::vector<SchedulerEvent> &events);
+
+    // 处理一帧响应，匹配到在途请求或被取代请求的墓碑时返回 true
+    bool onResponse(uint8_t command, const uint8_t *data, size_t len,
+                    Clock::time_point now, std::vector<SchedulerEvent> &events);
+
+    // 最近的超时时刻，没有在途请求时返回 false
+    bool nextDeadline(Clock::time_point &deadline) const;
+
+    size_t inFlightCount() const { return inFlight.size(); }
+    size_t queuedCount() const;
+    uint64_t coalescedCount() const { return coalesced; }
+    void clear();
+
+    // 根据请求帧推算期望的响应
+    static ResponseKey expectedResponse(const std::vector<uint8_t> &frame);
+    // 是否为可合并（后值覆盖前值）的设备控制指令
+    static bool isLatestWins(const std::vector<uint8_t> &frame);
+    // 设备控制帧是否写入指定 DP
+    static bool writesDP(const std::vector<uint8_t> &frame, uint8_t dpId);
+    // 设备控制帧写入的状态，第 i 位对应 ALL_STATUS_FIELDS[i]，其余命令为 0
+    static uint32_t fieldMask(const std::vector<uint8_t> &frame);
+
+private:
+    void fillWindow(Clock::time_point now, std::vector<SchedulerEvent> &events);
+    bool blocked(const ScheduledCommand &command) const;
+    void supersede(uint8_t dpId);
+
+    std::deque<ScheduledCommand> lanes[COMMANDPRIORITYCOUNT];   // 等待发送，按优先级分通道
+    std::vector<ScheduledCommand> inFlight;   // 已发送、等待响应，按发送顺序
+    std::vector<SchedulerEvent> cancelled;    // 入队时取消或被合并的指令，下一次 poll 时报告
+    std::vector<ScheduledCommand> superseded; // 被安全指令取代的在途请求（墓碑），各吸收一帧响应
+    size_t window;
+    Clock::duration timeout;
+    int maxAttempts;
+    uint64_t nextId = 1;
+    uint64_t coalesced = 0;                   // 被新指令覆盖而取消的未发送指令数
+};
+
+#endif // COMMANDSCHEDULER_H
@@ -0,0 +1,14 @@
+# 链接协议核心静态库：在使用方的 .pro 中 include(<相对路径>/core/core.pri)
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+PROTOCOL_CORE_OUT = $$shadowed($$PWD)
+
+win32:CONFIG(release, debug|release): PROTOCOL_CORE_LIBDIR = $$PROTOCOL_CORE_OUT/release
+else:win32:CONFIG(debug, debug|release): PROTOCOL_CORE_LIBDIR = $$PROTOCOL_CORE_OUT/debug
+else: PROTOCOL_CORE_LIBDIR = $$PROTOCOL_CORE_OUT
+
+LIBS += -L$$PROTOCOL_CORE_LIBDIR -lprotocol_core
+
+win32-g++|!win32: PRE_TARGETDEPS += $$PROTOCOL_CORE_LIBDIR/libprotocol_core.a
+else: PRE_TARGETDEPS += $$PROTOCOL_CORE_LIBDIR/protocol_core.lib
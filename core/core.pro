@@ -0,0 +1,39 @@
+# 协议核心静态库：帧编解码、DP 定义、帧解析、指令调度、设备状态、模式编译、抓包与回放
+# 纯 C++，不依赖 Qt，界面程序和命令行工具都链接此库
+TEMPLATE = lib
+TARGET = protocol_core
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+SOURCES += \
+    bytescan.cpp \
+    capture.cpp \
+    commandscheduler.cpp \
+    devicestate.cpp \
+    fileutil.cpp \
+    frameparser.cpp \
+    modeprogram.cpp \
+    modetimeline.cpp \
+    protocol.cpp \
+    replay.cpp \
+    ringbuffer.cpp
+
+HEADERS += \
+    bytescan.h \
+    capture.h \
+    commandscheduler.h \
+    devicestate.h \
+    dpcodec.h \
+    fileutil.h \
+    frameparser.h \
+    modeprogram.h \
+    modetimeline.h \
+    protocol.h \
+    replay.h \
+    ringbuffer.h
+
+# 多串口 epoll 反应器仅用于 Linux
+linux {
+    SOURCES += serialreactor.cpp
+    HEADERS += serialreactor.h
+}
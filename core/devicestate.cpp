@@ -0,0 +1,145 @@
+#include "devicestate.h"
+
+#include <cstring>
+
+DeviceStateModel::DeviceStateModel()
+{
+    reset();
+}
+
+void DeviceStateModel::reset()
+{
+    current = AllStatus{};
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        known[i] = false;
+        pending[i] = 0;
+    }
+}
+
+// 依次取出设备控制帧写入的各项状态：fn(ALL_STATUS_FIELDS 下标, 功能数据)
+template <typename Fn>
+void DeviceStateModel::forEachField(const uint8_t *frame, size_t len, Fn fn)
+{
+    if (len < FRAMEOVERHEAD + offset_BASE || frame[3] != DEVICE_CONTROL) {
+        return;
+    }
+    const DPDescriptor *dp = findDP(frame[6]);
+    if (!dp || len < static_cast<size_t>(FRAMEOVERHEAD + offset_BASE + dp->width)) {
+        return;
+    }
+
+    const uint8_t *value = frame + 6 + offset_BASE;
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        const DPField &field = ALL_STATUS_FIELDS[i];
+        if (dp->fields) {
+            fn(i, value + field.offset);
+        } else if (field.id == dp->id) {
+            fn(i, value);
+        }
+    }
+}
+
+void DeviceStateModel::store(size_t field, const uint8_t *value)
+{
+    const DPField &f = ALL_STATUS_FIELDS[field];
+    std::memcpy(reinterpret_cast<uint8_t*>(&current) + f.offset, value, dpDescriptor(f.id).width);
+    known[field] = true;
+}
+
+void DeviceStateModel::onSent(const uint8_t *frame, size_t len)
+{
+    forEachField(frame, len, [this](size_t field, const uint8_t *value) {
+        store(field, value);
+        ++pending[field];
+    });
+}
+
+void DeviceStateModel::onFinished(const uint8_t *frame, size_t len, bool completed)
+{
+    forEachField(frame, len, [this, completed](size_t field, const uint8_t *value) {
+        if (pending[field] > 0) {
+            --pending[field];
+        }
+        if (!completed) {
+            known[field] = false;
+        } else if (pending[field] == 0) {
+            store(field, value);   // 最后一条指令已确认
+        }
+    });
+}
+
+void DeviceStateModel::onReport(DPType id, const uint8_t *value)
+{
+    const DPDescriptor &dp = dpDescriptor(id);
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        const DPField &field = ALL_STATUS_FIELDS[i];
+        if (pending[i] > 0) {
+            continue;   // 以尚未结束的指令为准
+        }
+        if (dp.fields) {
+            store(i, value + field.offset);
+        } else if (field.id == id) {
+            store(i, value);
+        }
+    }
+}
+
+bool DeviceStateModel::isKnown(DPType id) const
+{
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        if (ALL_STATUS_FIELDS[i].id == id) {
+            return known[i];
+        }
+    }
+    return false;
+}
+
+uint32_t DeviceStateModel::changedFields(const AllStatus &target) const
+{
+    const uint8_t *want = reinterpret_cast<const uint8_t*>(&target);
+    const uint8_t *have = reinterpret_cast<const uint8_t*>(&current);
+
+    uint32_t fields = 0;
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        const DPField &field = ALL_STATUS_FIELDS[i];
+        if (!known[i] || std::memcmp(want + field.offset, have + field.offset, dpDescriptor(field.id).width) != 0) {
+            fields |= 1u << i;
+        }
+    }
+    return fields;
+}
+
+bool DeviceStateModel::preferAllStatus(uint32_t fields)
+{
+    size_t singleBytes = 0;
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        if (fields & (1u << i)) {
+            singleBytes += FRAMEOVERHEAD + offset_BASE + dpDescriptor(ALL_STATUS_FIELDS[i].id).width;
+        }
+    }
+    return singleBytes >= FRAMEOVERHEAD + offset_BASE + dpDescriptor(DPType::ALL_STATUS).width;
+}
+
+size_t DeviceStateModel::diff(const AllStatus &target, std::vector<std::vector<uint8_t>> &frames) const
+{
+    uint32_t fields = changedFields(target);
+    if (fields == 0) {
+        return 0;
+    }
+
+    const uint8_t *want = reinterpret_cast<const uint8_t*>(&target);
+    if (preferAllStatus(fields)) {
+        frames.push_back(createDeviceControlFrame(DPType::ALL_STATUS, want, dpDescriptor(DPType::ALL_STATUS).width).serialize());
+        return 1;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        if (fields & (1u << i)) {
+            const DPField &field = ALL_STATUS_FIELDS[i];
+            frames.push_back(createDeviceControlFrame(field.id, want + field.offset, dpDescriptor(field.id).width).serialize());
+            ++count;
+        }
+    }
+    return count;
+}
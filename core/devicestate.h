@@ -0,0 +1,54 @@
+#ifndef DEVICESTATE_H
+#define DEVICESTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "protocol.h"
+
+#define DEVICESTATEFIELDCOUNT   std::size(ALL_STATUS_FIELDS)
+
+// 下位机状态模型：按 ALL_STATUS 布局保存下位机的各项状态，不依赖 Qt
+// 发出设备控制帧时先记为预期值；有未结束的指令时，下位机上报的旧值不覆盖预期值；
+// 指令超时或被取代时该项状态变为未知，下次一定重新发送。
+// 发送端与目标状态比较，只发送有差异的 DP，状态一致时不发送。
+class DeviceStateModel {
+public:
+    DeviceStateModel();
+
+    // 状态全部变为未知（断开、心跳超时、下位机重启）
+    void reset();
+
+    // 设备控制帧已交给发送队列（整帧，含帧头和校验和），其余命令忽略
+    void onSent(const uint8_t *frame, size_t len);
+    // 指令结束：completed 为 false（超时、被取代）时该帧写入的状态变为未知，
+    // 确认的是最后一条未结束指令时，状态记为该指令的值
+    void onFinished(const uint8_t *frame, size_t len, bool completed);
+    // 下位机上报的 DP 功能数据，复合 DP 按组成逐项更新
+    void onReport(DPType id, const uint8_t *value);
+
+    bool isKnown(DPType id) const;
+    const AllStatus &status() const { return current; }
+
+    // 生成把下位机改为 target 所需的设备控制帧，返回帧数，状态一致时返回 0
+    // 只差一项时发送该 DP 的单独帧，差多项时发送字节更少的一帧 ALL_STATUS
+    size_t diff(const AllStatus &target, std::vector<std::vector<uint8_t>> &frames) const;
+
+    // 与 target 不同或未知的状态，第 i 位对应 ALL_STATUS_FIELDS[i]
+    uint32_t changedFields(const AllStatus &target) const;
+    // 按字节数判断这些状态是合并为一帧 ALL_STATUS 发送，还是逐个 DP 单独发送
+    static bool preferAllStatus(uint32_t fields);
+
+private:
+    template <typename Fn>
+    static void forEachField(const uint8_t *frame, size_t len, Fn fn);
+    void store(size_t field, const uint8_t *value);
+
+    AllStatus current;
+    bool known[DEVICESTATEFIELDCOUNT];
+    uint16_t pending[DEVICESTATEFIELDCOUNT];   // 各项状态未结束的指令数
+};
+
+#endif // DEVICESTATE_H
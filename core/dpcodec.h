@@ -0,0 +1,115 @@
+#ifndef DPCODEC_H
+#define DPCODEC_H
+
+#include "protocol.h"
+
+// 按 DP 类型编解码功能数据：值类型和宽度在编译期由 DP_TABLE 决定
+//   DP<DPType::CHANNEL>::encode(uint16_t)          -> 完整的设备控制帧
+//   DP<DPType::CHANNEL>::decode(data, len, value)  -> 从功能数据解码
+// 传入与 DP 宽度不符的类型（如把 uint16_t 传给 1 字节的 DP）会在编译期报错
+
+// 功能值类型：单值 DP 按宽度选择整数类型，复合 DP 使用对应的结构视图
+template <size_t Width>
+struct DPWidthType;
+template <>
+struct DPWidthType<1> { using type = uint8_t; };
+template <>
+struct DPWidthType<2> { using type = uint16_t; };
+
+template <DPType Id, bool Composite = dpDescriptor(Id).fields != nullptr>
+struct DPValueType {
+    using type = typename DPWidthType<dpDescriptor(Id).width>::type;
+};
+template <>
+struct DPValueType<DPType::ALL_STATUS, true> { using type = AllStatus; };
+
+// 功能值与大端字节之间的转换
+constexpr void encodeDPValue(uint8_t value, uint8_t *out) {
+    out[0] = value;
+}
+
+constexpr void encodeDPValue(uint16_t value, uint8_t *out) {
+    out[0] = (value >> 8) & 0xFF;   // 高字节
+    out[1] = value & 0xFF;          // 低字节
+}
+
+constexpr void encodeDPValue(const AllStatus &value, uint8_t *out) {
+    out[offsetof(AllStatus, offOn)] = value.offOn;
+    out[offsetof(AllStatus, accessSelect)] = value.accessSelect;
+    out[offsetof(AllStatus, maxChannel)] = value.maxChannel.bytes[0];
+    out[offsetof(AllStatus, maxChannel) + 1] = value.maxChannel.bytes[1];
+    out[offsetof(AllStatus, channel)] = value.channel.bytes[0];
+    out[offsetof(AllStatus, channel) + 1] = value.channel.bytes[1];
+    out[offsetof(AllStatus, positionControl)] = value.positionControl;
+    out[offsetof(AllStatus, afSelect)] = value.afSelect;
+}
+
+template <typename T>
+struct DPValueDecoder;
+
+template <>
+struct DPValueDecoder<uint8_t> {
+    static constexpr uint8_t decode(const uint8_t *data) { return data[0]; }
+};
+
+template <>
+struct DPValueDecoder<uint16_t> {
+    static constexpr uint16_t decode(const uint8_t *data) { return static_cast<uint16_t>(data[0] << 8 | data[1]); }
+};
+
+template <>
+struct DPValueDecoder<AllStatus> {
+    static constexpr AllStatus decode(const uint8_t *data) {
+        return {data[offsetof(AllStatus, offOn)],
+                data[offsetof(AllStatus, accessSelect)],
+                {{data[offsetof(AllStatus, maxChannel)], data[offsetof(AllStatus, maxChannel) + 1]}},
+                {{data[offsetof(AllStatus, channel)], data[offsetof(AllStatus, channel) + 1]}},
+                data[offsetof(AllStatus, positionControl)],
+                data[offsetof(AllStatus, afSelect)]};
+    }
+};
+
+template <DPType Id>
+struct DP {
+    using Value = typename DPValueType<Id>::type;
+    static constexpr size_t width = dpDescriptor(Id).width;
+    using Payload = std::array<uint8_t, width>;
+    using Frame = std::array<uint8_t, FRAMEOVERHEAD + offset_BASE + width>;
+
+    static_assert(sizeof(Value) == width, "DP value type does not match the DP_TABLE width");
+
+    // 功能值编码为功能数据
+    static constexpr Payload encodeValue(const Value &value) {
+        Payload payload{};
+        encodeDPValue(value, payload.data());
+        return payload;
+    }
+
+    // 功能值编码为完整的设备控制帧
+    static constexpr Frame encode(const Value &value) {
+        return makeDeviceControlFrame(Id, encodeValue(value));
+    }
+
+    // 只接受与 DP 宽度一致的值类型，其他类型需显式转换
+    template <typename T>
+    static Payload encodeValue(const T &value) = delete;
+    template <typename T>
+    static Frame encode(const T &value) = delete;
+
+    // 从功能数据（DP 头之后）解码，长度不足时返回 false
+    static constexpr bool decode(const uint8_t *data, size_t len, Value &value) {
+        if (len < width) {
+            return false;
+        }
+        value = DPValueDecoder<Value>::decode(data);
+        return true;
+    }
+
+    // 从响应数据（含 DP 头）解码，DP ID 不符或长度不足时返回 false
+    static constexpr bool decodeResponse(const uint8_t *data, size_t len, Value &value) {
+        return len >= offset_BASE && data[0] == static_cast<uint8_t>(Id)
+               && decode(data + offset_BASE, len - offset_BASE, value);
+    }
+};
+
+#endif // DPCODEC_H
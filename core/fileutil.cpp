@@ -0,0 +1,49 @@
+#include "fileutil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+std::wstring toWidePath(const std::string &path)
+{
+    int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring wide(len > 0 ? len - 1 : 0, L'\0');
+    if (len > 1) {
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], len);
+    }
+    return wide;
+}
+
+std::FILE *fopenUtf8(const std::string &path, const char *mode)
+{
+    std::string narrowMode(mode);
+    return _wfopen(toWidePath(path).c_str(), std::wstring(narrowMode.begin(), narrowMode.end()).c_str());
+}
+
+int renameUtf8(const std::string &from, const std::string &to)
+{
+    return _wrename(toWidePath(from).c_str(), toWidePath(to).c_str());
+}
+
+int removeUtf8(const std::string &path)
+{
+    return _wremove(toWidePath(path).c_str());
+}
+
+#else
+
+std::FILE *fopenUtf8(const std::string &path, const char *mode)
+{
+    return std::fopen(path.c_str(), mode);
+}
+
+int renameUtf8(const std::string &from, const std::string &to)
+{
+    return std::rename(from.c_str(), to.c_str());
+}
+
+int removeUtf8(const std::string &path)
+{
+    return std::remove(path.c_str());
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef FILEUTIL_H
+#define FILEUTIL_H
+
+#include <cstdio>
+#include <string>
+
+// UTF-8 路径的文件操作
+// Windows 下标准库的窄字符接口使用本地代码页，含中文的路径（如用户文档目录）需要转换为宽字符
+std::FILE *fopenUtf8(const std::string &path, const char *mode);
+int renameUtf8(const std::string &from, const std::string &to);
+int removeUtf8(const std::string &path);
+
+#ifdef _WIN32
+std::wstring toWidePath(const std::string &path);
+#endif
+
+#endif // FILEUTIL_H
@@ -0,0 +1,121 @@
+#include "frameparser.h"
+#include "bytescan.h"
+
+FrameParser::FrameParser(size_t bufferSize)
+    : buffer(bufferSize) {
+    frame.reserve(FRAMEMAXSIZE);
+}
+
+uint8_t FrameParser::checksum(const uint8_t *data, size_t len)
+{
+    return checksum8(data, len);
+}
+
+// 在缓冲区的连续片段中查找帧头，并检查跨越回绕点的一对字节
+// 返回 0x55 的位置；找不到返回 buffer.size()
+size_t FrameParser::findHeader() const
+{
+    size_t total = buffer.size();
+    size_t pos = 0;
+    while (pos + 1 < total) {
+        const uint8_t *segment;
+        size_t segmentLen = buffer.span(pos, segment);
+        size_t found = findSyncWord(segment, segmentLen);
+        if (found < segmentLen) {
+            return pos + found;
+        }
+
+        pos += segmentLen;
+        if (pos < total && segment[segmentLen - 1] == 0x55 && buffer.peek(pos) == 0xAA) {
+            return pos - 1;
+        }
+    }
+    return total;
+}
+
+size_t FrameParser::feed(const uint8_t *data, size_t len)
+{
+    counters.bytes += len;
+    size_t dropped = buffer.write(data, len);
+    counters.overflowBytes += dropped;
+    parse();
+    return dropped;
+}
+
+void FrameParser::reset()
+{
+    buffer.clear();
+}
+
+void FrameParser::report(ParseError error, const uint8_t *data, size_t len)
+{
+    if (onError) {
+        onError(error, data, len);
+    }
+}
+
+// 接收并解析多个下位机响应
+void FrameParser::parse()
+{
+    while (buffer.size() >= 7) {  // 至少需要7个字节（帧头 + 版本 + 命令 + 数据长度 + 校验和）
+        // 查找帧头
+        size_t headerPos = findHeader();
+
+        if (headerPos + 1 >= buffer.size()) {
+            // 丢弃无效数据，末尾的 0x55 可能是下一帧帧头的一半，保留
+            size_t discard = buffer.peek(buffer.size() - 1) == 0x55 ? buffer.size() - 1 : buffer.size();
+            counters.discardedBytes += discard;
+            buffer.consume(discard);
+            report(ParseError::NoHeader);
+            break;
+        }
+
+        // 丢弃帧头之前的无效数据
+        counters.discardedBytes += headerPos;
+        buffer.consume(headerPos);
+        if (buffer.size() < 7) {
+            break;  // 帧头之后数据不足，等待更多数据
+        }
+
+        // 获取数据长度
+        uint16_t dataLength = (buffer.peek(4) << 8) | buffer.peek(5);
+        // 与 ProtocolFrame::decode 使用同一上限，通过校验的帧都能解码
+        if (dataLength > FRAMEMAXDATALENGTH) {
+            counters.lengthErrors++;
+            counters.discardedBytes++;
+            buffer.consume(1);  // 跳过伪帧头，重新同步
+            report(ParseError::InvalidLength);
+            continue;
+        }
+        size_t totalFrameSize = 6 + dataLength + 1;  // 帧头 + 数据 + 校验和
+
+        // 检查缓冲区是否包含完整的一帧，不完整则保留在缓冲区中等待更多数据
+        if (buffer.size() < totalFrameSize) {
+            break;
+        }
+
+        // 提取完整帧：连续存放时直接引用缓冲区，跨越回绕点时才拷贝
+        const uint8_t *framePtr;
+        if (buffer.span(0, framePtr) < totalFrameSize) {
+            frame.resize(totalFrameSize);
+            buffer.copyOut(0, frame.data(), totalFrameSize);
+            framePtr = frame.data();
+        }
+
+        // 接收帧校验和
+        if (checksum8(framePtr, totalFrameSize - 1) != framePtr[totalFrameSize - 1]) {
+            counters.checksumErrors++;
+            counters.discardedBytes++;
+            report(ParseError::ChecksumMismatch, framePtr, totalFrameSize);
+            buffer.consume(1);  // 校验和失败，跳过该帧头重新同步
+            continue;
+        }
+
+        // 已处理的帧：移动读指针（数据在下次写入前保持有效）
+        buffer.consume(totalFrameSize);
+        counters.frames++;
+        if (onFrame) {
+            onFrame(framePtr, totalFrameSize);
+        }
+    }
+}
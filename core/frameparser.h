@@ -0,0 +1,67 @@
+#ifndef FRAMEPARSER_H
+#define FRAMEPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "protocol.h"
+#include "ringbuffer.h"
+
+// 帧解析错误类型
+enum class ParseError {
+    NoHeader,           // 缓冲区中没有帧头，无效数据已丢弃
+    InvalidLength,      // 数据长度超过 FRAMEMAXDATALENGTH，视为伪帧头
+    ChecksumMismatch    // 校验和错误
+};
+
+// 串口字节流帧解析
+// 帧格式：55 AA | 版本 | 命令字 | 长度(2字节，大端) | 数据 | 校验和
+// 输入的字节先进入环形缓冲区，不完整的帧保留到下次输入；
+// 校验通过的帧和解析错误通过回调交给调用方，不依赖 Qt
+class FrameParser {
+public:
+    struct Stats {
+        uint64_t bytes = 0;             // 输入的字节数
+        uint64_t frames = 0;            // 校验通过的帧数
+        uint64_t checksumErrors = 0;
+        uint64_t lengthErrors = 0;
+        uint64_t discardedBytes = 0;    // 帧头之前被丢弃的无效字节
+        uint64_t overflowBytes = 0;     // 缓冲区溢出丢弃的字节
+    };
+
+    // 完整帧（含帧头和校验和），指针只在回调期间有效
+    using FrameHandler = std::function<void(const uint8_t *frame, size_t len)>;
+    // 解析错误；ChecksumMismatch 时 frame 指向出错的整帧，其余情况为空
+    using ErrorHandler = std::function<void(ParseError error, const uint8_t *frame, size_t len)>;
+
+    explicit FrameParser(size_t bufferSize = RXBUFFERSIZE);
+
+    void setFrameHandler(FrameHandler handler) { onFrame = std::move(handler); }
+    void setErrorHandler(ErrorHandler handler) { onError = std::move(handler); }
+
+    // 输入一段字节并解析其中的完整帧，返回因缓冲区溢出丢弃的字节数
+    size_t feed(const uint8_t *data, size_t len);
+
+    void reset();
+
+    const Stats &stats() const { return counters; }
+    size_t pendingBytes() const { return buffer.size(); }
+
+    // 8位累加校验和
+    static uint8_t checksum(const uint8_t *data, size_t len);
+
+private:
+    void parse();
+    size_t findHeader() const;
+    void report(ParseError error, const uint8_t *frame = nullptr, size_t len = 0);
+
+    RxRingBuffer buffer;
+    std::vector<uint8_t> frame;   // 整帧跨越缓冲区回绕点时使用的拷贝缓冲
+    FrameHandler onFrame;
+    ErrorHandler onError;
+    Stats counters;
+};
+
+#endif // FRAMEPARSER_H
@@ -0,0 +1,80 @@
+#include "modeprogram.h"
+
+#include <utility>
+
+bool ModeProgram::compile(const ModeBase &base, const std::vector<ModeRow> &rows, uint32_t loopCount,
+                          ModeProgram &program, size_t &errorRow, std::string &error)
+{
+    if (rows.size() > MODEMAXSTEPS) {
+        errorRow = MODEMAXSTEPS;
+        error = "模式表行数超过上限";
+        return false;
+    }
+
+    // 下位机类型未知时 A~D 与 F0~F9 均可
+    ValueNameTable accessNames = accessValueNames(base.afSelect);
+    uint8_t accessCount = accessNames.count > 0 ? accessNames.count : FAccessValueNames.count;
+
+    std::vector<ModeStep> steps;
+    steps.reserve(rows.size());
+    for (size_t row = 0; row < rows.size(); ++row) {
+        const ModeRow &r = rows[row];
+        if (r.accessSelect >= accessCount) {
+            errorRow = row;
+            error = "通道值超出当前下位机类型的范围";
+            return false;
+        }
+        if (r.positionControl >= DevCtrlValueNames.count) {
+            errorRow = row;
+            error = "设备控制值无效";
+            return false;
+        }
+
+        ModeStep step = {};
+        step.target.offOn = base.offOn;
+        step.target.accessSelect = r.accessSelect;
+        step.target.maxChannel.set(base.maxChannel);
+        step.target.channel.set(r.channel);
+        step.target.positionControl = r.positionControl;
+        step.target.afSelect = base.afSelect;
+
+        step.allStatusFrame = DP<DPType::ALL_STATUS>::encode(step.target);
+
+        const uint8_t *value = reinterpret_cast<const uint8_t*>(&step.target);
+        for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+            const DPField &field = ALL_STATUS_FIELDS[i];
+            ProtocolFrame frame = createDeviceControlFrame(field.id, value + field.offset, dpDescriptor(field.id).width);
+            step.fieldFrameLength[i] = static_cast<uint8_t>(frame.encode(step.fieldFrames[i], MODEFIELDFRAMESIZE));
+        }
+
+        step.delayMs = r.delayMs;
+        step.row = static_cast<uint16_t>(row);
+        steps.push_back(step);
+    }
+
+    program.stepList = std::move(steps);
+    program.loops = loopCount;
+    return true;
+}
+
+size_t ModeProgram::selectFrames(const ModeStep &step, const DeviceStateModel &model,
+                                 ModeFrameRef (&frames)[DEVICESTATEFIELDCOUNT])
+{
+    uint32_t fields = model.changedFields(step.target);
+    if (fields == 0) {
+        return 0;
+    }
+
+    if (DeviceStateModel::preferAllStatus(fields)) {
+        frames[0] = {step.allStatusFrame.data(), step.allStatusFrame.size(), DPType::ALL_STATUS};
+        return 1;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < DEVICESTATEFIELDCOUNT; ++i) {
+        if (fields & (1u << i)) {
+            frames[count++] = {step.fieldFrames[i], step.fieldFrameLength[i], ALL_STATUS_FIELDS[i].id};
+        }
+    }
+    return count;
+}
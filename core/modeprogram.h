@@ -0,0 +1,73 @@
+#ifndef MODEPROGRAM_H
+#define MODEPROGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "protocol.h"
+#include "dpcodec.h"
+#include "devicestate.h"
+
+#define MODEMAXSTEPS            4096     // 模式表最多行数
+#define MODEFIELDFRAMESIZE      (FRAMEOVERHEAD + offset_BASE + 2)   // 单个状态 DP 的设备控制帧最大长度
+
+// 模式表中一行的取值（已从表格文本解析）
+struct ModeRow {
+    uint8_t accessSelect;       // 通道
+    uint16_t channel;           // 频道值
+    uint8_t positionControl;    // 设备控制
+    uint32_t delayMs;           // 发送后的延时
+};
+
+// 整个模式共用的状态，编译时从当前设备状态取得
+struct ModeBase {
+    uint8_t offOn;
+    uint16_t maxChannel;
+    uint8_t afSelect;
+};
+
+// 编译后的一步：目标状态及其预先编码好的帧
+struct ModeStep {
+    AllStatus target;
+    DP<DPType::ALL_STATUS>::Frame allStatusFrame;                       // 整帧 ALL_STATUS
+    uint8_t fieldFrames[DEVICESTATEFIELDCOUNT][MODEFIELDFRAMESIZE];    // 各项状态的单独帧，按 ALL_STATUS_FIELDS 顺序
+    uint8_t fieldFrameLength[DEVICESTATEFIELDCOUNT];
+    uint32_t delayMs;
+    uint16_t row;               // 对应的表格行（从 0 开始）
+};
+
+// 要发送的一帧，指向 ModeStep 内的字节
+struct ModeFrameRef {
+    const uint8_t *data;
+    size_t length;
+    DPType dp;
+};
+
+// 编译后的模式程序：执行前一次性生成，执行时只按顺序遍历，不再解析表格、不再编码
+class ModeProgram {
+public:
+    ModeProgram() = default;
+
+    // 编译失败时返回 false，errorRow 为出错行，error 为原因
+    static bool compile(const ModeBase &base, const std::vector<ModeRow> &rows, uint32_t loopCount,
+                        ModeProgram &program, size_t &errorRow, std::string &error);
+
+    const std::vector<ModeStep> &steps() const { return stepList; }
+    size_t size() const { return stepList.size(); }
+    bool empty() const { return stepList.empty(); }
+    const ModeStep &operator[](size_t index) const { return stepList[index]; }
+    uint32_t loopCount() const { return loops; }
+
+    // 选出把下位机从 model 的状态改为该步目标状态所需的帧，返回帧数，状态一致时返回 0
+    // 选择规则与 DeviceStateModel::diff 相同，只是引用预编码的字节，不分配内存
+    static size_t selectFrames(const ModeStep &step, const DeviceStateModel &model,
+                               ModeFrameRef (&frames)[DEVICESTATEFIELDCOUNT]);
+
+private:
+    std::vector<ModeStep> stepList;
+    uint32_t loops = 0;
+};
+
+#endif // MODEPROGRAM_H
@@ -0,0 +1,82 @@
+#include "modetimeline.h"
+
+ModeTimeline::ModeTimeline(const ModeProgram &program)
+    : stepCount(program.size()),
+    loops(program.empty() ? 0 : program.loopCount())
+{
+    // 偏移用整数毫秒累加，长时间循环也不会产生浮点误差
+    offsetMs.reserve(program.size());
+    for (const ModeStep &step : program.steps()) {
+        offsetMs.push_back(loopMs);
+        loopMs += step.delayMs;
+    }
+    if (stepCount == 0) {
+        stepCount = 1;      // 避免除零，loops 为 0 时 done() 恒为真
+    }
+}
+
+void ModeTimeline::start(Clock::time_point now)
+{
+    origin = now;
+    position = 0;
+    paused = false;
+    stats = Lateness();
+}
+
+void ModeTimeline::pause(Clock::time_point now)
+{
+    if (!paused) {
+        paused = true;
+        pausedAt = now;
+    }
+}
+
+void ModeTimeline::resume(Clock::time_point now)
+{
+    if (paused) {
+        origin += now - pausedAt;
+        paused = false;
+    }
+}
+
+ModeTimeline::Clock::time_point ModeTimeline::at(uint64_t index) const
+{
+    uint64_t loopIndex = index / stepCount;
+    uint64_t stepIndex = index % stepCount;
+    uint64_t ms = loopIndex * loopMs + (stepIndex < offsetMs.size() ? offsetMs[stepIndex] : 0);
+    return origin + std::chrono::milliseconds(ms);
+}
+
+uint64_t ModeTimeline::skipSuperseded(Clock::time_point now)
+{
+    uint64_t total = stepCount * loops;
+    uint64_t skipped = 0;
+    // 只有当前步骤已过期、且后面计划时刻更晚的一步也已过期时才跳过；
+    // 与下一步计划时刻相同的步骤（零延时行）总是发送
+    while (position + 1 < total && at(position) < at(position + 1) && at(position + 1) < now) {
+        ++position;
+        ++skipped;
+    }
+    stats.skipped += skipped;
+    return skipped;
+}
+
+std::chrono::microseconds ModeTimeline::advance(Clock::time_point sentAt)
+{
+    std::chrono::microseconds late(0);
+    if (sentAt > deadline()) {
+        late = std::chrono::duration_cast<std::chrono::microseconds>(sentAt - deadline());
+    }
+
+    ++stats.steps;
+    stats.total += late;
+    if (late > stats.max) {
+        stats.max = late;
+    }
+    if (late >= std::chrono::milliseconds(MODELATEWARNMS)) {
+        ++stats.lateSteps;
+    }
+
+    ++position;
+    return late;
+}
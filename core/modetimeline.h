@@ -0,0 +1,78 @@
+#ifndef MODETIMELINE_H
+#define MODETIMELINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modeprogram.h"
+
+#define MODELATEWARNMS          20       // 步骤迟到超过此值（毫秒）时告警
+
+// 模式执行时间线
+// 每一步的发送时刻都按程序开始时刻加上之前所有延时的累计值计算（单调时钟的绝对时刻），
+// 而不是在上一步发送之后再等待延时，因此发送、日志和定时器唤醒的耗时不会逐步累积。
+// 某步迟到时，下一步的等待相应缩短；迟到超过一步的延时时，已被后面到期步骤取代的步骤直接跳过
+// （每步都是完整的目标状态），只发送最后一个到期的步骤，补发量不随落后的时间增长；
+// 与下一步计划时刻相同的步骤（零延时行）不算被取代，总是发送。
+// 不依赖 Qt，时间由调用方传入。
+class ModeTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 迟到统计
+    struct Lateness {
+        uint64_t steps = 0;                         // 已发送步数
+        uint64_t lateSteps = 0;                     // 迟到超过 MODELATEWARNMS 的步数
+        uint64_t skipped = 0;                       // 因落后被后续步骤取代、未发送的步数
+        std::chrono::microseconds max{0};
+        std::chrono::microseconds total{0};
+    };
+
+    explicit ModeTimeline(const ModeProgram &program);
+
+    // 以 now 为程序开始时刻，回到第一步
+    void start(Clock::time_point now);
+
+    // 所有步骤均已发送
+    bool done() const { return position >= stepCount * loops; }
+    uint32_t loop() const { return static_cast<uint32_t>(position / stepCount); }
+    size_t step() const { return static_cast<size_t>(position % stepCount); }
+
+    // 当前步骤的计划发送时刻
+    Clock::time_point deadline() const { return at(position); }
+    // 最后一步的延时结束、整个程序结束的时刻
+    Clock::time_point endTime() const { return at(stepCount * loops); }
+
+    // 暂停期间时间线整体后移，恢复后剩余步骤的间隔不变，暂停时长不计入迟到
+    void pause(Clock::time_point now);
+    void resume(Clock::time_point now);
+    bool isPaused() const { return paused; }
+
+    // 跳过在 now 之前已过期、且计划时刻更晚的下一步也已过期的步骤，返回跳过的步数
+    // 与下一步计划时刻相同的步骤不跳过
+    uint64_t skipSuperseded(Clock::time_point now);
+
+    // 当前步骤已在 sentAt 发送：记录迟到并前进到下一步，返回迟到时间（提前时为 0）
+    std::chrono::microseconds advance(Clock::time_point sentAt);
+
+    const Lateness &lateness() const { return stats; }
+
+private:
+    // 第 index 步（跨循环计数）的计划时刻
+    Clock::time_point at(uint64_t index) const;
+
+    std::vector<uint64_t> offsetMs;     // 各步相对本轮开始的偏移（毫秒）
+    uint64_t loopMs = 0;                // 一轮的总时长
+    uint64_t stepCount = 0;
+    uint64_t loops = 0;
+
+    Clock::time_point origin;
+    uint64_t position = 0;
+    bool paused = false;
+    Clock::time_point pausedAt;
+    Lateness stats;
+};
+
+#endif // MODETIMELINE_H
@@ -0,0 +1,208 @@
+#include "protocol.h"
+#include "bytescan.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+// DP 描述表：ID 不重复，ALL_STATUS 的组成都在其数据范围内
+static constexpr bool dpTableValid() {
+    for (size_t i = 0; i < DP_COUNT; ++i) {
+        if (DP_INDEX[static_cast<uint8_t>(DP_TABLE[i].id)] != i) {
+            return false;
+        }
+        for (size_t f = 0; f < DP_TABLE[i].fieldCount; ++f) {
+            const DPField &field = DP_TABLE[i].fields[f];
+            if (!findDP(static_cast<uint8_t>(field.id))
+                || field.offset + dpDescriptor(field.id).width > DP_TABLE[i].width) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(dpTableValid(), "DP_TABLE has duplicate ids or ALL_STATUS fields out of range");
+
+// 固定指令帧须与下位机参考程序 lower_computer_80c51/main.c 一致
+static_assert(frameEquals(HEARTBEAT_FRAME, {{0x55, 0xAA, 0x00, 0x00, 0x00, 0x00, 0xFF}}),
+              "heartbeat frame differs from lower_computer_80c51 command1");
+static_assert(frameEquals(QUERY_STATUS_FRAME, {{0x55, 0xAA, 0x00, 0x08, 0x00, 0x00, 0x07}}),
+              "query status frame differs from lower_computer_80c51 command2");
+static_assert(frameEquals(makeFrame(HEARTBEAT, std::array<uint8_t, 1>{{0x01}}, 0x03),
+                          {{0x55, 0xAA, 0x03, 0x00, 0x00, 0x01, 0x01, 0x04}}),
+              "heartbeat response differs from lower_computer_80c51 response1");
+static_assert(frameEquals(makeFrame(MCU_RESPONSE, std::array<uint8_t, 12>{{0x69, 0x02, 0x00, 0x08, 0x01, 0x01,
+                                                                          0x11, 0x22, 0x10, 0x33, 0x02, 0x01}}, 0x03),
+                          {{0x55, 0xAA, 0x03, 0x07, 0x00, 0x0C, 0x69, 0x02, 0x00, 0x08,
+                            0x01, 0x01, 0x11, 0x22, 0x10, 0x33, 0x02, 0x01, 0x03}}),
+              "all status response differs from lower_computer_80c51 response2");
+static_assert(frameEquals(POSITION_STOP_FRAME, {{0x55, 0xAA, 0x00, 0x06, 0x00, 0x05, 0x67, 0x04, 0x00, 0x01, 0x01, 0x77}}),
+              "stop frame layout changed");
+
+
+// 构造函数实现
+ProtocolFrame::ProtocolFrame()
+    : frameHeader(FRAME_HEADER), version(VERSION), command(0), dataLength(0), data(), checksum(0) {
+    checksum = computeChecksum();
+}
+
+ProtocolFrame::ProtocolFrame(uint8_t cmd, const uint8_t *dataPayload, size_t len)
+    : frameHeader(FRAME_HEADER), version(VERSION), command(cmd), dataLength(0), data(), checksum(0) {
+    if (len > FRAMEMAXDATALENGTH) {
+        throw std::length_error("Frame payload too long");
+    }
+    dataLength = static_cast<uint16_t>(len);
+    if (len > 0) {
+        std::memcpy(data, dataPayload, len);
+    }
+    checksum = computeChecksum(); // 计算校验和
+}
+
+ProtocolFrame::ProtocolFrame(uint8_t cmd, const std::vector<uint8_t>& dataPayload)
+    : ProtocolFrame(cmd, dataPayload.data(), dataPayload.size()) {
+}
+
+// 计算校验和函数实现
+uint8_t ProtocolFrame::calculateChecksum(const std::vector<uint8_t>& data) const {
+    return calculateChecksum(data.data(), data.size());
+}
+
+uint8_t ProtocolFrame::calculateChecksum(const uint8_t *data, size_t len) {
+    return checksum8(data, len);   // 对256取余
+}
+
+uint8_t ProtocolFrame::computeChecksum() const {
+    uint8_t sum = static_cast<uint8_t>((frameHeader >> 8) + frameHeader + version + command
+                                       + (dataLength >> 8) + dataLength);
+    return sum + calculateChecksum(data, dataLength);
+}
+
+// 编码函数实现
+size_t ProtocolFrame::encode(uint8_t *out, size_t capacity) const {
+    size_t size = encodedSize();
+    if (capacity < size) {
+        return 0;
+    }
+
+    out[0] = (frameHeader >> 8) & 0xFF;   // 帧头的高字节
+    out[1] = frameHeader & 0xFF;          // 帧头的低字节
+    out[2] = version;                     // 版本号
+    out[3] = command;                     // 命令
+    out[4] = (dataLength >> 8) & 0xFF;    // 数据长度的高字节
+    out[5] = dataLength & 0xFF;           // 数据长度的低字节
+    if (dataLength > 0) {
+        std::memcpy(out + 6, data, dataLength);   // 数据
+    }
+    out[size - 1] = checksum;             // 校验和
+    return size;
+}
+
+// 序列化函数实现
+std::vector<uint8_t> ProtocolFrame::serialize(bool withChecksum) const {
+    std::vector<uint8_t> frame(encodedSize());
+    encode(frame.data(), frame.size());
+    if (!withChecksum) {
+        frame.pop_back();
+    }
+    return frame;
+}
+
+// 解码函数实现
+bool ProtocolFrame::decode(const uint8_t *rawData, size_t len, ProtocolFrame &frame) {
+    if (len < FRAMEOVERHEAD) {
+        return false;
+    }
+
+    uint16_t dataLength = (rawData[4] << 8) | rawData[5];
+    if (dataLength > FRAMEMAXDATALENGTH || len < static_cast<size_t>(FRAMEOVERHEAD + dataLength)) {
+        return false;
+    }
+
+    frame.frameHeader = (rawData[0] << 8) | rawData[1];
+    frame.version = rawData[2];
+    frame.command = rawData[3];
+    frame.dataLength = dataLength;
+    if (dataLength > 0) {
+        std::memcpy(frame.data, rawData + 6, dataLength);
+    }
+    frame.checksum = rawData[6 + dataLength];
+    return true;
+}
+
+// 反序列化字节流，解析响应
+ProtocolFrame ProtocolFrame::deserialize(const std::vector<uint8_t>& rawData) {
+    ProtocolFrame frame;
+    if (!decode(rawData.data(), rawData.size(), frame)) {
+        throw std::invalid_argument("Invalid frame size");
+    }
+    return frame;
+}
+
+
+
+
+
+
+// 心跳检测构造
+ProtocolFrame createHeartbeatFrame() {
+    return ProtocolFrame(HEARTBEAT, nullptr, 0);  // 初始接收0x00，后续0x01
+}
+
+// 查询状态构造
+ProtocolFrame createQueryStatusFrame() {
+    return ProtocolFrame(QUERY_STATUS, nullptr, 0);
+}
+
+// 设备控制构造
+ProtocolFrame createDeviceControlFrame(DPType dpId, const uint8_t *commandValue, size_t len) {
+    // 确保 dpId 在 DP 描述表中
+    const DPDescriptor *dp = findDP(static_cast<uint8_t>(dpId));
+    if (!dp) {
+        throw std::invalid_argument("Invalid DPType: no corresponding DataType found.");
+    }
+    if (len > FRAMEMAXDATALENGTH - 4) {
+        throw std::length_error("Command value too long");
+    }
+
+    // 构造数据
+    uint8_t data[FRAMEMAXDATALENGTH];
+    data[0] = static_cast<uint8_t>(dpId);                 // DP ID
+    data[1] = static_cast<uint8_t>(dp->dataType);         // 数据类型
+    data[2] = (len >> 8) & 0xFF;                          // 功能长度的高字节
+    data[3] = len & 0xFF;                                 // 功能长度的低字节
+    if (len > 0) {
+        std::memcpy(data + 4, commandValue, len);         // 插入功能指令数据
+    }
+
+    return ProtocolFrame(DEVICE_CONTROL, data, 4 + len);
+}
+
+ProtocolFrame createDeviceControlFrame(DPType dpId, const std::vector<uint8_t>& commandValue) {
+    return createDeviceControlFrame(dpId, commandValue.data(), commandValue.size());
+}
+
+
+// DP 功能值格式化
+static void formatName(const char *name, char *out, size_t size) {
+    std::snprintf(out, size, "%s", name ? name : "Unknown");
+}
+
+void formatNumber(uint32_t value, uint8_t, char *out, size_t size) {
+    std::snprintf(out, size, "%u", static_cast<unsigned>(value));
+}
+
+void formatSwitch(uint32_t value, uint8_t, char *out, size_t size) {
+    formatName(SwitchValueNames.name(value), out, size);
+}
+
+void formatAccess(uint32_t value, uint8_t afSelect, char *out, size_t size) {
+    formatName(accessValueNames(afSelect).name(value), out, size);
+}
+
+void formatDevCtrl(uint32_t value, uint8_t, char *out, size_t size) {
+    formatName(DevCtrlValueNames.name(value), out, size);
+}
+
+void formatAFSelect(uint32_t value, uint8_t, char *out, size_t size) {
+    formatName(AFSelectValueNames.name(value), out, size);
+}
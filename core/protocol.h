@@ -0,0 +1,386 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+#define HEARTBEATTIMESET 10000     // 心跳间隔时间
+#define RESPONSETIMEOUTTIMESET  200      // 响应超时时间设置
+#define SENDMAXATTEMPTS         3        // 每条指令最多发送次数
+#define SENDWINDOWSIZE          4        // 同时等待响应的指令数上限（发送窗口）
+#define offset_BASE             4        // 设备控制数据中 DP 头（DP ID + 数据类型 + 功能长度）的长度
+#define FRAMEMAXDATALENGTH      16       // 帧数据长度上限，收发共用（ALL_STATUS 为 12 字节）
+#define FRAMEOVERHEAD           7        // 帧头 + 版本 + 命令 + 数据长度 + 校验和
+#define FRAMEMAXSIZE            (FRAMEOVERHEAD + FRAMEMAXDATALENGTH)
+
+// 协议字段定义
+const uint16_t FRAME_HEADER = 0x55AA;  // 帧头
+const uint8_t VERSION = 0x00;          // 默认版本
+
+// 消息类型定义
+enum CommandType {
+    HEARTBEAT = 0x00,
+    QUERY_STATUS = 0x08,
+    DEVICE_CONTROL = 0x06,
+    MCU_RESPONSE = 0x07
+};
+
+// 协议帧结构体
+// 数据内容内联存储，构造、编码、解码均不分配堆内存
+class ProtocolFrame {
+public:
+    uint16_t frameHeader;              // 帧头
+    uint8_t version;                   // 版本号
+    uint8_t command;                   // 指令
+    uint16_t dataLength;               // 数据长度
+    uint8_t data[FRAMEMAXDATALENGTH];  // 数据内容
+    uint8_t checksum;                  // 校验和
+
+    // 构造函数，数据超过 FRAMEMAXDATALENGTH 时抛出 std::length_error
+    ProtocolFrame();
+    ProtocolFrame(uint8_t cmd, const uint8_t *dataPayload, size_t len);
+    ProtocolFrame(uint8_t cmd, const std::vector<uint8_t>& dataPayload);
+
+    // 计算校验和
+    uint8_t calculateChecksum(const std::vector<uint8_t>& data) const;
+    static uint8_t calculateChecksum(const uint8_t *data, size_t len);
+
+    // 编码后的整帧长度
+    size_t encodedSize() const { return FRAMEOVERHEAD + dataLength; }
+
+    // 一次写出 帧头、数据、校验和 到调用方缓冲区，返回写入的字节数；缓冲区不足时返回 0
+    size_t encode(uint8_t *out, size_t capacity) const;
+
+    // 将帧序列化为字节流
+    std::vector<uint8_t> serialize(bool withChecksum = true) const;
+
+    // 解码整帧，长度不合法时返回 false；保留原始校验和，不重新计算
+    static bool decode(const uint8_t *rawData, size_t len, ProtocolFrame &frame);
+
+    // 反序列化字节流，解析响应
+    static ProtocolFrame deserialize(const std::vector<uint8_t>& rawData);
+
+private:
+    // 帧头、版本、命令、长度与数据的累加和
+    uint8_t computeChecksum() const;
+};
+
+
+enum class DPType : uint8_t {
+    OFF_ON = 0x14,
+    ACCESS_SELECT = 0x15,
+    MAXCHANNEL = 0x65,
+    CHANNEL = 0x66,
+    POSITION_CONTROL = 0x67,
+    A_F_SELECT = 0x68,
+    ALL_STATUS = 0x69
+};
+
+
+// 定义 数据类型 枚举
+enum class DataType : uint8_t {
+    TYPE_01 = 0x01,
+    TYPE_02 = 0x02,
+    TYPE_04 = 0x04
+};
+
+// 定义开关值
+enum class SwitchValue : uint8_t {
+    SWITCH_OFF = 0x00,
+    SWITCH_ON  = 0x01,
+};
+
+// 定义AD类型通道值
+enum class ADAccessValue : uint8_t {
+    ADACCESS_A = 0x00,
+    ADACCESS_B = 0x01,
+    ADACCESS_C = 0x02,
+    ADACCESS_D = 0x03
+};
+
+// 定义F类型通道值
+enum class FAccessValue : uint8_t {
+    FACCESS_F0 = 0x00,
+    FACCESS_F1 = 0x01,
+    FACCESS_F2 = 0x02,
+    FACCESS_F3 = 0x03,
+    FACCESS_F4 = 0x04,
+    FACCESS_F5 = 0x05,
+    FACCESS_F6 = 0x06,
+    FACCESS_F7 = 0x07,
+    FACCESS_F8 = 0x08,
+    FACCESS_F9 = 0x09
+};
+
+// 定义设备控制功能值
+enum class DevCtrlValue : uint8_t {
+    DevCtrl_UP = 0x00,
+    DevCtrl_STOP = 0x01,
+    DevCtrl_DOWN = 0x02
+};
+
+// 定义A/F通道类型值
+enum class AFSelectValue : uint8_t {
+    AFSelect_A = 0x00,
+    AFSelect_F = 0x01
+};
+
+
+// 枚举值名称表：值从 0 开始连续，按值直接索引
+struct ValueNameTable {
+    const char *const *names;
+    uint8_t count;
+
+    // 值超出范围时返回 nullptr
+    constexpr const char *name(uint32_t value) const {
+        return value < count ? names[value] : nullptr;
+    }
+
+    // 按名称查找值，equal(name) 判断名称是否匹配
+    template <typename Equal>
+    bool find(Equal equal, uint8_t &value) const {
+        for (uint8_t i = 0; i < count; ++i) {
+            if (equal(names[i])) {
+                value = i;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template <size_t N>
+constexpr ValueNameTable makeNameTable(const char *const (&names)[N]) {
+    return {names, static_cast<uint8_t>(N)};
+}
+
+inline constexpr const char *SWITCH_VALUE_NAMES[] = {"OFF", "ON"};
+inline constexpr const char *ADACCESS_VALUE_NAMES[] = {"A", "B", "C", "D"};
+inline constexpr const char *FACCESS_VALUE_NAMES[] = {"F0", "F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9"};
+inline constexpr const char *DEVCTRL_VALUE_NAMES[] = {"UP", "STOP", "DOWN"};
+inline constexpr const char *AFSELECT_VALUE_NAMES[] = {"A", "F"};
+
+constexpr ValueNameTable SwitchValueNames = makeNameTable(SWITCH_VALUE_NAMES);
+constexpr ValueNameTable ADAccessValueNames = makeNameTable(ADACCESS_VALUE_NAMES);
+constexpr ValueNameTable FAccessValueNames = makeNameTable(FACCESS_VALUE_NAMES);
+constexpr ValueNameTable DevCtrlValueNames = makeNameTable(DEVCTRL_VALUE_NAMES);
+constexpr ValueNameTable AFSelectValueNames = makeNameTable(AFSELECT_VALUE_NAMES);
+
+// 当前下位机类型（A/F）可用的通道名称，类型未知时为空表
+constexpr ValueNameTable accessValueNames(uint8_t afSelect) {
+    return afSelect == static_cast<uint8_t>(AFSelectValue::AFSelect_A) ? ADAccessValueNames
+         : afSelect == static_cast<uint8_t>(AFSelectValue::AFSelect_F) ? FAccessValueNames
+                                                                        : ValueNameTable{nullptr, 0};
+}
+
+// 按名称查找通道值，A~D 与 F0~F9 均可
+template <typename Equal>
+bool findAccessValue(Equal equal, uint8_t &value) {
+    return ADAccessValueNames.find(equal, value) || FAccessValueNames.find(equal, value);
+}
+
+
+// DP 功能数据解码（大端）
+using DPDecoder = uint32_t (*)(const uint8_t *value);
+// DP 功能值格式化为显示文本，afSelect 为当前下位机 A/F 类型
+using DPFormatter = void (*)(uint32_t value, uint8_t afSelect, char *out, size_t size);
+
+constexpr uint32_t decodeU8(const uint8_t *value) {
+    return value[0];
+}
+
+constexpr uint32_t decodeU16(const uint8_t *value) {
+    return static_cast<uint32_t>(value[0] << 8 | value[1]);
+}
+
+void formatNumber(uint32_t value, uint8_t afSelect, char *out, size_t size);
+void formatSwitch(uint32_t value, uint8_t afSelect, char *out, size_t size);
+void formatAccess(uint32_t value, uint8_t afSelect, char *out, size_t size);
+void formatDevCtrl(uint32_t value, uint8_t afSelect, char *out, size_t size);
+void formatAFSelect(uint32_t value, uint8_t afSelect, char *out, size_t size);
+
+// 大端 16 位字段，按字节存放，可直接覆盖在功能数据上
+struct BigEndian16 {
+    uint8_t bytes[2];
+
+    constexpr uint16_t value() const {
+        return static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+    }
+    constexpr void set(uint16_t value) {
+        bytes[0] = (value >> 8) & 0xFF;   // 高字节
+        bytes[1] = value & 0xFF;          // 低字节
+    }
+};
+
+// ALL_STATUS 功能数据（8 字节）的结构视图，成员均为字节，没有填充
+struct AllStatus {
+    uint8_t offOn;              // 开关状态
+    uint8_t accessSelect;       // 通道
+    BigEndian16 maxChannel;     // 最大频道值
+    BigEndian16 channel;        // 频道值
+    uint8_t positionControl;    // 设备控制
+    uint8_t afSelect;           // A/F状态
+};
+static_assert(sizeof(AllStatus) == 8, "AllStatus must match the 8-byte ALL_STATUS payload");
+
+// 复合 DP 中一个状态的位置
+struct DPField {
+    DPType id;
+    uint8_t offset;
+};
+
+// ALL_STATUS 的组成，按处理顺序排列：必须先确定下位机类型，然后再处理其他状态
+inline constexpr DPField ALL_STATUS_FIELDS[] = {
+    {DPType::A_F_SELECT, offsetof(AllStatus, afSelect)},
+    {DPType::OFF_ON, offsetof(AllStatus, offOn)},
+    {DPType::ACCESS_SELECT, offsetof(AllStatus, accessSelect)},
+    {DPType::MAXCHANNEL, offsetof(AllStatus, maxChannel)},
+    {DPType::CHANNEL, offsetof(AllStatus, channel)},
+    {DPType::POSITION_CONTROL, offsetof(AllStatus, positionControl)}
+};
+
+// DP 描述：数据类型、功能数据长度、解码与格式化
+struct DPDescriptor {
+    DPType id;
+    DataType dataType;
+    uint8_t width;              // 功能数据长度（字节）
+    const char *name;
+    DPDecoder decode;           // 复合 DP 为空
+    DPFormatter format;         // 复合 DP 为空
+    const DPField *fields;      // 复合 DP 的组成，其余为空
+    uint8_t fieldCount;
+    bool latestWins;            // 发送队列中未发送的旧值被新值替换，只发送最终状态
+};
+
+// DP 描述表，新增 DP 只需在此添加一项
+inline constexpr DPDescriptor DP_TABLE[] = {
+    {DPType::OFF_ON, DataType::TYPE_01, 1, "OFF_ON", decodeU8, formatSwitch, nullptr, 0, false},
+    {DPType::ACCESS_SELECT, DataType::TYPE_04, 1, "ACCESS_SELECT", decodeU8, formatAccess, nullptr, 0, true},
+    {DPType::MAXCHANNEL, DataType::TYPE_02, 2, "MAXCHANNEL", decodeU16, formatNumber, nullptr, 0, true},
+    {DPType::CHANNEL, DataType::TYPE_02, 2, "CHANNEL", decodeU16, formatNumber, nullptr, 0, true},
+    {DPType::POSITION_CONTROL, DataType::TYPE_04, 1, "POSITION_CONTROL", decodeU8, formatDevCtrl, nullptr, 0, true},
+    {DPType::A_F_SELECT, DataType::TYPE_01, 1, "A_F_SELECT", decodeU8, formatAFSelect, nullptr, 0, false},
+    {DPType::ALL_STATUS, DataType::TYPE_02, 8, "ALL_STATUS", nullptr, nullptr,
+     ALL_STATUS_FIELDS, static_cast<uint8_t>(std::size(ALL_STATUS_FIELDS)), false}
+};
+constexpr size_t DP_COUNT = std::size(DP_TABLE);
+
+// DP ID 到 DP_TABLE 下标的索引，编译期生成，未定义的 ID 为 0xFF
+constexpr std::array<uint8_t, 256> makeDPIndex() {
+    std::array<uint8_t, 256> index{};
+    for (size_t i = 0; i < index.size(); ++i) {
+        index[i] = 0xFF;
+    }
+    for (size_t i = 0; i < DP_COUNT; ++i) {
+        index[static_cast<uint8_t>(DP_TABLE[i].id)] = static_cast<uint8_t>(i);
+    }
+    return index;
+}
+inline constexpr std::array<uint8_t, 256> DP_INDEX = makeDPIndex();
+
+// 按 DP ID 查找描述，未定义的 ID 返回 nullptr
+constexpr const DPDescriptor *findDP(uint8_t id) {
+    return DP_INDEX[id] == 0xFF ? nullptr : &DP_TABLE[DP_INDEX[id]];
+}
+
+constexpr const DPDescriptor &dpDescriptor(DPType id) {
+    return DP_TABLE[DP_INDEX[static_cast<uint8_t>(id)]];
+}
+
+// DP ID 对应的数据类型（编译期可用）
+constexpr DataType dpDataType(DPType dpId) {
+    return dpDescriptor(dpId).dataType;
+}
+
+// 检查按 DP_TABLE 顺序排列的附属表（如界面处理函数表）是否与 DP_TABLE 一一对应
+template <typename T, size_t N>
+constexpr bool matchesDPTable(const T (&entries)[N]) {
+    if (N != DP_COUNT) {
+        return false;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        if (entries[i].id != DP_TABLE[i].id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 编译期帧构造：长度和校验和在编译期计算，结果为完整的帧字节
+template <size_t N>
+constexpr std::array<uint8_t, FRAMEOVERHEAD + N> makeFrame(uint8_t cmd, const std::array<uint8_t, N> &payload,
+                                                           uint8_t version = VERSION) {
+    std::array<uint8_t, FRAMEOVERHEAD + N> frame{};
+    frame[0] = (FRAME_HEADER >> 8) & 0xFF;
+    frame[1] = FRAME_HEADER & 0xFF;
+    frame[2] = version;
+    frame[3] = cmd;
+    frame[4] = (N >> 8) & 0xFF;
+    frame[5] = N & 0xFF;
+    uint8_t sum = frame[0] + frame[1] + frame[2] + frame[3] + frame[4] + frame[5];
+    for (size_t i = 0; i < N; ++i) {
+        frame[6 + i] = payload[i];
+        sum += payload[i];
+    }
+    frame[6 + N] = sum;
+    return frame;
+}
+
+// 编译期设备控制帧：DP ID + 数据类型 + 功能长度 + 功能指令数据
+template <size_t N>
+constexpr std::array<uint8_t, FRAMEOVERHEAD + 4 + N> makeDeviceControlFrame(DPType dpId,
+                                                                             const std::array<uint8_t, N> &value) {
+    std::array<uint8_t, 4 + N> data{};
+    data[0] = static_cast<uint8_t>(dpId);
+    data[1] = static_cast<uint8_t>(dpDataType(dpId));
+    data[2] = (N >> 8) & 0xFF;
+    data[3] = N & 0xFF;
+    for (size_t i = 0; i < N; ++i) {
+        data[4 + i] = value[i];
+    }
+    return makeFrame(DEVICE_CONTROL, data);
+}
+
+template <size_t N>
+constexpr bool frameEquals(const std::array<uint8_t, N> &a, const std::array<uint8_t, N> &b) {
+    for (size_t i = 0; i < N; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 固定指令帧，发送时直接复制
+constexpr auto HEARTBEAT_FRAME = makeFrame(HEARTBEAT, std::array<uint8_t, 0>{});
+constexpr auto QUERY_STATUS_FRAME = makeFrame(QUERY_STATUS, std::array<uint8_t, 0>{});
+constexpr auto POSITION_UP_FRAME = makeDeviceControlFrame(DPType::POSITION_CONTROL,
+    std::array<uint8_t, 1>{{static_cast<uint8_t>(DevCtrlValue::DevCtrl_UP)}});
+constexpr auto POSITION_STOP_FRAME = makeDeviceControlFrame(DPType::POSITION_CONTROL,
+    std::array<uint8_t, 1>{{static_cast<uint8_t>(DevCtrlValue::DevCtrl_STOP)}});
+constexpr auto POSITION_DOWN_FRAME = makeDeviceControlFrame(DPType::POSITION_CONTROL,
+    std::array<uint8_t, 1>{{static_cast<uint8_t>(DevCtrlValue::DevCtrl_DOWN)}});
+
+
+
+// 心跳检测构造
+ProtocolFrame createHeartbeatFrame();
+
+// 查询状态构造
+ProtocolFrame createQueryStatusFrame();
+
+// 设备控制构造
+ProtocolFrame createDeviceControlFrame(DPType dpId, const uint8_t *commandValue, size_t len);
+ProtocolFrame createDeviceControlFrame(DPType dpId, const std::vector<uint8_t>& commandValue);
+
+
+
+#endif
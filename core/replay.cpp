@@ -0,0 +1,86 @@
+#include "replay.h"
+
+#include <chrono>
+#include <thread>
+
+ReplayEngine::ReplayEngine(const CaptureReader &reader)
+    : reader(reader) {
+}
+
+FrameParser &ReplayEngine::parserFor(uint8_t portId, CaptureDirection direction, ReplayReport &report)
+{
+    uint16_t key = static_cast<uint16_t>(static_cast<uint8_t>(direction) << 8 | portId);
+    auto it = parsers.find(key);
+    if (it != parsers.end()) {
+        return it->second;
+    }
+
+    FrameParser &parser = parsers[key];
+    parser.setFrameHandler([this, portId, &report](const uint8_t *frame, size_t len) {
+        uint8_t dpId = (frame[3] == 0x07 && len > 7) ? frame[6] : 0;   // 只有 MCU_RESPONSE 的数据区以 DP ID 开头
+        report.frameTypes[static_cast<uint16_t>(frame[3] << 8 | dpId)]++;
+        if (onFrame) {
+            onFrame(portId, frame, len);
+        }
+    });
+    parser.setErrorHandler([this, portId](ParseError error, const uint8_t *frame, size_t len) {
+        if (onError) {
+            onError(portId, error, frame, len);
+        }
+    });
+    return parser;
+}
+
+ReplayReport ReplayEngine::run(const ReplayOptions &options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    ReplayReport report;
+    report.truncated = reader.truncated();
+    parsers.clear();
+
+    Clock::time_point start = Clock::now();
+    uint64_t firstTimestamp = 0;
+    bool first = true;
+
+    for (size_t i = 0; i < reader.recordCount(); ++i) {
+        CaptureRecord record = reader.record(i);
+        if (options.portId >= 0 && record.portId != options.portId) {
+            continue;
+        }
+        if (record.direction == CaptureDirection::TX && !options.includeTx) {
+            continue;
+        }
+
+        // 按记录的相对时间调度，倍速为 0 时不等待
+        if (first) {
+            firstTimestamp = record.timestampNs;
+            first = false;
+        }
+        if (options.speed > 0) {
+            auto offset = std::chrono::nanoseconds(
+                static_cast<int64_t>((record.timestampNs - firstTimestamp) / options.speed));
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(offset));
+        }
+
+        parserFor(record.portId, record.direction, report).feed(record.data, record.length);
+        report.records++;
+    }
+
+    report.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (const auto &entry : parsers) {
+        const FrameParser::Stats &stats = entry.second.stats();
+        report.parser.bytes += stats.bytes;
+        report.parser.frames += stats.frames;
+        report.parser.checksumErrors += stats.checksumErrors;
+        report.parser.lengthErrors += stats.lengthErrors;
+        report.parser.discardedBytes += stats.discardedBytes;
+        report.parser.overflowBytes += stats.overflowBytes;
+    }
+    if (report.elapsedSeconds > 0) {
+        report.framesPerSecond = report.parser.frames / report.elapsedSeconds;
+        report.bytesPerSecond = report.parser.bytes / report.elapsedSeconds;
+    }
+    return report;
+}
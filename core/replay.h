@@ -0,0 +1,52 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+
+#include "capture.h"
+#include "frameparser.h"
+
+// 回放参数
+struct ReplayOptions {
+    double speed = 1.0;         // 回放倍速：1 为实时，N 为 N 倍速，0 为不限速
+    int portId = -1;            // 只回放指定端口，-1 为全部端口
+    bool includeTx = false;     // 是否同时解析发送方向的数据
+};
+
+// 回放统计
+struct ReplayReport {
+    uint64_t records = 0;                  // 回放的抓包记录数
+    FrameParser::Stats parser;             // 所有端口解析统计之和
+    std::map<uint16_t, uint64_t> frameTypes;   // (命令字 << 8 | DP ID) -> 帧数
+    double elapsedSeconds = 0;
+    double framesPerSecond = 0;
+    double bytesPerSecond = 0;
+    bool truncated = false;                // 抓包文件末尾存在不完整的记录
+};
+
+// 离线回放：把抓包中的接收数据按记录时间（或不限速）送入与串口线程相同的帧解析器
+class ReplayEngine {
+public:
+    using FrameHandler = std::function<void(uint8_t portId, const uint8_t *frame, size_t len)>;
+    using ErrorHandler = std::function<void(uint8_t portId, ParseError error, const uint8_t *frame, size_t len)>;
+
+    explicit ReplayEngine(const CaptureReader &reader);
+
+    void setFrameHandler(FrameHandler handler) { onFrame = std::move(handler); }
+    void setErrorHandler(ErrorHandler handler) { onError = std::move(handler); }
+
+    ReplayReport run(const ReplayOptions &options);
+
+private:
+    FrameParser &parserFor(uint8_t portId, CaptureDirection direction, ReplayReport &report);
+
+    const CaptureReader &reader;
+    std::map<uint16_t, FrameParser> parsers;   // (方向 << 8 | 端口) -> 解析器，各端口各方向的字节流独立
+    FrameHandler onFrame;
+    ErrorHandler onError;
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,77 @@
+#include "ringbuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// 容量向上取整到2的幂，读写位置用掩码回绕
+static size_t roundUpPow2(size_t n)
+{
+    size_t cap = 1;
+    while (cap < n) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+RxRingBuffer::RxRingBuffer(size_t capacity)
+    : storage(roundUpPow2(capacity < 16 ? 16 : capacity)), mask(storage.size() - 1) {
+}
+
+size_t RxRingBuffer::write(const uint8_t *data, size_t len)
+{
+    size_t dropped = 0;
+
+    // 单次写入超过容量时，只保留最后 capacity 个字节
+    if (len > storage.size()) {
+        dropped += len - storage.size();
+        data += len - storage.size();
+        len = storage.size();
+    }
+
+    // 空间不足时丢弃最旧的数据
+    size_t freeSpace = storage.size() - count;
+    if (len > freeSpace) {
+        dropped += len - freeSpace;
+        consume(len - freeSpace);
+    }
+
+    size_t writePos = (readPos + count) & mask;
+    size_t first = std::min(len, storage.size() - writePos);
+    std::memcpy(&storage[writePos], data, first);
+    std::memcpy(&storage[0], data + first, len - first);
+    count += len;
+
+    return dropped;
+}
+
+size_t RxRingBuffer::span(size_t offset, const uint8_t *&data) const
+{
+    if (offset >= count) {
+        data = nullptr;
+        return 0;
+    }
+    size_t pos = (readPos + offset) & mask;
+    data = &storage[pos];
+    return std::min(count - offset, storage.size() - pos);
+}
+
+void RxRingBuffer::copyOut(size_t offset, uint8_t *dst, size_t len) const
+{
+    size_t pos = (readPos + offset) & mask;
+    size_t first = std::min(len, storage.size() - pos);
+    std::memcpy(dst, &storage[pos], first);
+    std::memcpy(dst + first, &storage[0], len - first);
+}
+
+void RxRingBuffer::consume(size_t n)
+{
+    n = std::min(n, count);
+    readPos = (readPos + n) & mask;
+    count -= n;
+}
+
+void RxRingBuffer::clear()
+{
+    readPos = 0;
+    count = 0;
+}
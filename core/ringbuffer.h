@@ -0,0 +1,44 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define RXBUFFERSIZE            4096     // 接收环形缓冲区容量（2的幂）
+
+// 串口接收环形缓冲区
+// 跨多次 readyRead 保留未处理完的字节，帧解析通过读指针原地消费，不做 erase 搬移
+class RxRingBuffer {
+public:
+    explicit RxRingBuffer(size_t capacity = RXBUFFERSIZE);
+
+    size_t size() const { return count; }
+    size_t capacity() const { return storage.size(); }
+    bool empty() const { return count == 0; }
+
+    // 写入数据，空间不足时丢弃最旧的字节，返回被丢弃的字节数
+    size_t write(const uint8_t *data, size_t len);
+
+    // 读取读指针之后第 offset 个字节（不移动读指针）
+    uint8_t peek(size_t offset) const { return storage[(readPos + offset) & mask]; }
+
+    // 读指针之后 offset 处开始、不跨越回绕点的连续字节，返回其长度
+    size_t span(size_t offset, const uint8_t *&data) const;
+
+    // 从读指针之后 offset 处拷贝 len 个字节到 dst（不移动读指针）
+    void copyOut(size_t offset, uint8_t *dst, size_t len) const;
+
+    // 移动读指针，消费 n 个字节
+    void consume(size_t n);
+
+    void clear();
+
+private:
+    std::vector<uint8_t> storage;
+    size_t mask;
+    size_t readPos = 0;    // 读指针
+    size_t count = 0;      // 当前缓存的字节数
+};
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,461 @@
+#include "serialreactor.h"
+#include "protocol.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+static const uint32_t WAKE_TOKEN = 0xFFFFFFFF;    // epoll 事件中代表唤醒 eventfd 的编号
+
+struct SerialReactor::Port {
+    int id;
+    int fd;
+    std::string path;
+    FrameParser parser;
+    CommandScheduler scheduler;
+
+    std::vector<uint8_t> txBuffer;     // 写缓冲区满时未写出的字节
+    size_t txOffset = 0;
+    bool writeArmed = false;           // 是否在等待 EPOLLOUT
+
+    Clock::time_point nextHeartbeat;
+    bool dirty = false;                // 有新指令，需要填充发送窗口
+    bool failed = false;               // 读写失败，本轮事件处理结束后关闭
+};
+
+SerialReactor::SerialReactor()
+    : heartbeatInterval(std::chrono::milliseconds(HEARTBEATTIMESET)),
+    windowSize(SENDWINDOWSIZE) {
+}
+
+SerialReactor::~SerialReactor()
+{
+    stop();
+}
+
+bool SerialReactor::baudToSpeed(int baud, unsigned &speed)
+{
+    switch (baud) {
+        case 1200:   speed = B1200;   return true;
+        case 2400:   speed = B2400;   return true;
+        case 4800:   speed = B4800;   return true;
+        case 9600:   speed = B9600;   return true;
+        case 19200:  speed = B19200;  return true;
+        case 38400:  speed = B38400;  return true;
+        case 57600:  speed = B57600;  return true;
+        case 115200: speed = B115200; return true;
+        case 230400: speed = B230400; return true;
+        case 460800: speed = B460800; return true;
+        case 921600: speed = B921600; return true;
+        default:     return false;
+    }
+}
+
+// 原始模式 8N1，无流控，非阻塞读
+static bool configureTty(int fd, int baud)
+{
+    unsigned speed;
+    if (!SerialReactor::baudToSpeed(baud, speed)) {
+        errno = EINVAL;
+        return false;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        return false;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return true;
+}
+
+bool SerialReactor::start()
+{
+    if (running.load()) {
+        return true;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        stop();
+        return false;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u32 = WAKE_TOKEN;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    running.store(true);
+    thread = std::thread(&SerialReactor::run, this);
+    return true;
+}
+
+void SerialReactor::stop()
+{
+    if (running.exchange(false)) {
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeFd, &one, sizeof(one));
+        (void)n;
+        thread.join();
+    }
+
+    for (auto &port : ports) {
+        if (port) {
+            ::close(port->fd);
+        }
+    }
+    ports.clear();
+    openPorts.store(0);
+
+    if (wakeFd >= 0) {
+        ::close(wakeFd);
+        wakeFd = -1;
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+}
+
+int SerialReactor::openPort(const std::string &path, int baud)
+{
+    int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (!configureTty(fd, baud)) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+
+    int id = nextPortId.fetch_add(1);
+    openPorts.fetch_add(1);
+    post({Request::Open, id, fd, path, {}, {}, 0, CommandPriority::Background});
+    return id;
+}
+
+void SerialReactor::closePort(int port)
+{
+    post({Request::Close, port, -1, {}, {}, {}, 0, CommandPriority::Background});
+}
+
+void SerialReactor::enqueue(int port, std::vector<uint8_t> frame, const std::string &label, CommandPriority priority,
+                            uint32_t tag)
+{
+    post({Request::Command, port, -1, {}, std::move(frame), label, tag, priority});
+}
+
+// 请求排队后唤醒反应器线程；队列原本非空时线程已被唤醒，不再写 eventfd
+void SerialReactor::post(Request request)
+{
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        wake = requests.empty();
+        requests.push_back(std::move(request));
+    }
+    if (wake && wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeFd, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void SerialReactor::run()
+{
+    struct epoll_event ready[REACTORMAXEVENTS];
+
+    // start 之前提交的请求没有写 eventfd，先处理一次
+    drainRequests(Clock::now());
+    Clock::time_point wake = serviceAll(Clock::now());
+
+    while (running.load(std::memory_order_relaxed)) {
+        int timeout = -1;
+        if (wake != Clock::time_point::max()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(wake - Clock::now()).count();
+            timeout = remaining <= 0 ? 0 : static_cast<int>((remaining + 999) / 1000);
+        }
+
+        int count = epoll_wait(epollFd, ready, REACTORMAXEVENTS, timeout);
+        if (count < 0 && errno != EINTR) {
+            break;
+        }
+        counters.wakeups.fetch_add(1, std::memory_order_relaxed);
+
+        for (int i = 0; i < count; ++i) {
+            uint32_t token = ready[i].data.u32;
+            if (token == WAKE_TOKEN) {
+                uint64_t value;
+                ssize_t n = ::read(wakeFd, &value, sizeof(value));
+                (void)n;
+                drainRequests(Clock::now());
+                continue;
+            }
+            if (token >= ports.size() || !ports[token]) {
+                continue;
+            }
+
+            Port &port = *ports[token];
+            if (ready[i].events & EPOLLIN) {
+                readPort(port);
+            }
+            if ((ready[i].events & EPOLLOUT) && !port.failed) {
+                flushPort(port);
+            }
+            if ((ready[i].events & (EPOLLERR | EPOLLHUP)) && !port.failed) {
+                failPort(port, EIO);
+            }
+        }
+
+        wake = serviceAll(Clock::now());
+    }
+}
+
+void SerialReactor::drainRequests(Clock::time_point now)
+{
+    std::vector<Request> pending;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        pending.swap(requests);
+    }
+
+    for (Request &request : pending) {
+        switch (request.type) {
+            case Request::Open:
+                addPort(request.port, request.fd, request.path, now);
+                break;
+            case Request::Close:
+                removePort(request.port);
+                break;
+            case Request::Command:
+                if (request.port >= 0 && static_cast<size_t>(request.port) < ports.size() && ports[request.port]) {
+                    Port &port = *ports[request.port];
+                    port.scheduler.enqueue(std::move(request.frame), request.label, request.tag, request.priority);
+                    port.dirty = true;
+                }
+                break;
+        }
+    }
+}
+
+void SerialReactor::addPort(int id, int fd, const std::string &path, Clock::time_point now)
+{
+    if (ports.size() <= static_cast<size_t>(id)) {
+        ports.resize(id + 1);
+    }
+
+    std::unique_ptr<Port> port(new Port);
+    port->id = id;
+    port->fd = fd;
+    port->path = path;
+    port->scheduler.setWindowSize(windowSize);
+    port->nextHeartbeat = now;
+
+    Port *raw = port.get();
+    raw->parser.setFrameHandler([this, raw](const uint8_t *frame, size_t len) {
+        counters.frames.fetch_add(1, std::memory_order_relaxed);
+        if (callbacks.frame) {
+            callbacks.frame(raw->id, frame, len);
+        }
+        // 按 命令字 + DP ID 与在途请求配对
+        raw->scheduler.onResponse(frame[3], frame + 6, len - FRAMEOVERHEAD, Clock::now(), events);
+        handleEvents(*raw);
+    });
+    raw->parser.setErrorHandler([this, raw](ParseError error, const uint8_t *, size_t) {
+        if (callbacks.parseError) {
+            callbacks.parseError(raw->id, error);
+        }
+    });
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u32 = static_cast<uint32_t>(id);
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        int error = errno;
+        ports[id] = std::move(port);
+        failPort(*raw, error);
+        removePort(id);
+        return;
+    }
+    ports[id] = std::move(port);
+}
+
+void SerialReactor::removePort(int id)
+{
+    if (id < 0 || static_cast<size_t>(id) >= ports.size() || !ports[id]) {
+        return;
+    }
+
+    // 关闭描述符会自动从 epoll 中移除
+    ::close(ports[id]->fd);
+    ports[id].reset();
+    openPorts.fetch_sub(1);
+}
+
+void SerialReactor::readPort(Port &port)
+{
+    uint8_t buffer[4096];
+    for (;;) {
+        ssize_t n = ::read(port.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            counters.bytesIn.fetch_add(n, std::memory_order_relaxed);
+            if (capture) {
+                capture->append(CaptureDirection::RX, static_cast<uint8_t>(port.id), buffer, n);
+            }
+            port.parser.feed(buffer, static_cast<size_t>(n));
+            if (port.failed) {
+                return;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            failPort(port, errno);
+        }
+        return;
+    }
+}
+
+void SerialReactor::writeFrame(Port &port, const std::vector<uint8_t> &frame)
+{
+    if (port.failed) {
+        return;
+    }
+    if (capture) {
+        capture->append(CaptureDirection::TX, static_cast<uint8_t>(port.id), frame.data(), frame.size());
+    }
+
+    // 前面还有未写完的数据时只追加，保持字节顺序
+    if (port.txOffset < port.txBuffer.size()) {
+        port.txBuffer.insert(port.txBuffer.end(), frame.begin(), frame.end());
+        return;
+    }
+
+    port.txBuffer.assign(frame.begin(), frame.end());
+    port.txOffset = 0;
+    flushPort(port);
+}
+
+// 尽量写出缓冲区，写不完时等待 EPOLLOUT
+void SerialReactor::flushPort(Port &port)
+{
+    while (port.txOffset < port.txBuffer.size()) {
+        ssize_t n = ::write(port.fd, port.txBuffer.data() + port.txOffset, port.txBuffer.size() - port.txOffset);
+        if (n > 0) {
+            port.txOffset += n;
+            counters.bytesOut.fetch_add(n, std::memory_order_relaxed);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            failPort(port, errno);
+            return;
+        }
+        break;
+    }
+
+    bool pending = port.txOffset < port.txBuffer.size();
+    if (!pending) {
+        port.txBuffer.clear();
+        port.txOffset = 0;
+    }
+    if (pending != port.writeArmed) {
+        struct epoll_event event = {};
+        event.events = pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.u32 = static_cast<uint32_t>(port.id);
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, port.fd, &event);
+        port.writeArmed = pending;
+    }
+}
+
+// 执行调度器事件：发送与重发写入串口，全部事件交给回调
+void SerialReactor::handleEvents(Port &port)
+{
+    for (const SchedulerEvent &event : events) {
+        if (event.type == SchedulerEvent::Transmit || event.type == SchedulerEvent::Retransmit) {
+            writeFrame(port, event.command.frame);
+        }
+        if (callbacks.scheduler) {
+            callbacks.scheduler(port.id, event);
+        }
+    }
+    events.clear();
+}
+
+void SerialReactor::failPort(Port &port, int error)
+{
+    if (port.failed) {
+        return;
+    }
+    port.failed = true;
+    if (callbacks.portError) {
+        callbacks.portError(port.id, error);
+    }
+}
+
+// 处理到期的心跳、超时和新指令，返回下一次需要唤醒的时刻
+SerialReactor::Clock::time_point SerialReactor::serviceAll(Clock::time_point now)
+{
+    Clock::time_point wake = Clock::time_point::max();
+
+    for (auto &slot : ports) {
+        if (!slot) {
+            continue;
+        }
+        Port &port = *slot;
+        if (port.failed) {
+            removePort(port.id);
+            continue;
+        }
+
+        bool heartbeatDue = heartbeatInterval.count() > 0 && now >= port.nextHeartbeat;
+        if (heartbeatDue) {
+            port.scheduler.enqueue(std::vector<uint8_t>(HEARTBEAT_FRAME.begin(), HEARTBEAT_FRAME.end()), "发送心跳帧", 0,
+                                   CommandPriority::Background);
+            port.nextHeartbeat = now + heartbeatInterval;
+        }
+
+        Clock::time_point deadline;
+        bool hasDeadline = port.scheduler.nextDeadline(deadline);
+        if (port.dirty || heartbeatDue || (hasDeadline && deadline <= now)) {
+            port.dirty = false;
+            port.scheduler.poll(now, events);
+            handleEvents(port);
+            if (port.failed) {
+                removePort(port.id);
+                continue;
+            }
+            hasDeadline = port.scheduler.nextDeadline(deadline);
+        }
+
+        if (hasDeadline) {
+            wake = std::min(wake, deadline);
+        }
+        if (heartbeatInterval.count() > 0) {
+            wake = std::min(wake, port.nextHeartbeat);
+        }
+    }
+    return wake;
+}
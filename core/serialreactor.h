@@ -0,0 +1,128 @@
+#ifndef SERIALREACTOR_H
+#define SERIALREACTOR_H
+
+// 仅 Linux：基于 epoll 的多串口反应器
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture.h"
+#include "commandscheduler.h"
+#include "frameparser.h"
+
+#define REACTORMAXEVENTS        256      // 每次 epoll_wait 取出的事件数上限
+
+// 反应器回调，全部在反应器线程中执行，不应阻塞
+struct ReactorHandlers {
+    // 校验通过的响应帧（含帧头和校验和），指针只在回调期间有效
+    std::function<void(int port, const uint8_t *frame, size_t len)> frame;
+    // 调度器事件：发送、重发、完成、失败
+    std::function<void(int port, const SchedulerEvent &event)> scheduler;
+    // 帧解析错误
+    std::function<void(int port, ParseError error)> parseError;
+    // 读写失败或设备断开（errno），端口随后被关闭
+    std::function<void(int port, int error)> portError;
+};
+
+// 多串口反应器
+// 一个线程用 epoll 复用全部 tty：非阻塞打开、termios 配置为原始模式 8N1，
+// 每个端口有独立的 FrameParser 和 CommandScheduler，与 Qt 串口线程使用相同的解析与调度逻辑。
+// 超时和心跳不使用定时器，由 epoll_wait 的超时驱动。
+// 端口更多时可以创建多个反应器，把端口分片到各自的线程。
+class SerialReactor {
+public:
+    using Clock = CommandScheduler::Clock;
+
+    struct Stats {
+        std::atomic<uint64_t> wakeups{0};     // epoll_wait 返回次数
+        std::atomic<uint64_t> bytesIn{0};
+        std::atomic<uint64_t> bytesOut{0};
+        std::atomic<uint64_t> frames{0};      // 校验通过的帧数
+    };
+
+    SerialReactor();
+    ~SerialReactor();
+
+    SerialReactor(const SerialReactor &) = delete;
+    SerialReactor &operator=(const SerialReactor &) = delete;
+
+    // 以下设置在 start 之前调用
+    void setHandlers(ReactorHandlers handlers) { callbacks = std::move(handlers); }
+    void setCapture(CaptureWriter *writer) { capture = writer; }
+    // 心跳间隔（毫秒），0 表示不发送心跳
+    void setHeartbeatInterval(int ms) { heartbeatInterval = std::chrono::milliseconds(ms); }
+    void setWindowSize(size_t size) { windowSize = size; }
+
+    bool start();
+    void stop();
+
+    // 打开并配置 tty，返回端口编号；失败返回 -1，errno 给出原因。可在任意线程调用
+    int openPort(const std::string &path, int baud = 9600);
+    void closePort(int port);
+
+    // 指令加入端口的发送队列，可在任意线程调用
+    void enqueue(int port, std::vector<uint8_t> frame, const std::string &label, CommandPriority priority, uint32_t tag = 0);
+
+    size_t portCount() const { return openPorts.load(std::memory_order_relaxed); }
+    const Stats &stats() const { return counters; }
+
+    // 波特率转换为 termios 速率常量，不支持时返回 false
+    static bool baudToSpeed(int baud, unsigned &speed);
+
+private:
+    struct Port;
+
+    // 其他线程提交给反应器线程的请求
+    struct Request {
+        enum Type { Open, Close, Command } type;
+        int port;
+        int fd;
+        std::string path;
+        std::vector<uint8_t> frame;
+        std::string label;
+        uint32_t tag;
+        CommandPriority priority;
+    };
+
+    void post(Request request);
+    void run();
+    void drainRequests(Clock::time_point now);
+    void addPort(int id, int fd, const std::string &path, Clock::time_point now);
+    void removePort(int id);
+    void readPort(Port &port);
+    void flushPort(Port &port);
+    void writeFrame(Port &port, const std::vector<uint8_t> &frame);
+    void service(Port &port, Clock::time_point now);
+    void handleEvents(Port &port);
+    void failPort(Port &port, int error);
+    Clock::time_point serviceAll(Clock::time_point now);
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::mutex requestMutex;
+    std::vector<Request> requests;
+    std::atomic<int> nextPortId{0};
+    std::atomic<size_t> openPorts{0};
+
+    // 以下成员只在反应器线程中访问
+    std::vector<std::unique_ptr<Port>> ports;   // 按端口编号索引，已关闭为空
+    std::vector<SchedulerEvent> events;
+    ReactorHandlers callbacks;
+    CaptureWriter *capture = nullptr;
+    Clock::duration heartbeatInterval;
+    size_t windowSize;
+    Stats counters;
+};
+
+#endif // SERIALREACTOR_H
@@ -0,0 +1,218 @@
+#include "devicesession.h"
+
+DeviceSession::DeviceSession(int id, CaptureWriter *capture, QObject *parent)
+    : QObject(parent),
+    sessionId(id),
+    thread(new QThread(this)),
+    worker(new SerialWorker)
+{
+    qRegisterMetaType<LineSettings>();
+    qRegisterMetaType<CommandPriority>();
+
+    // 工作对象移动到会话线程，与界面之间只通过排队信号通信
+    worker->setCapture(capture, static_cast<quint8>(id));
+    worker->moveToThread(thread);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &DeviceSession::openPortRequested, worker, &SerialWorker::openPort);
+    connect(this, &DeviceSession::closePortRequested, worker, &SerialWorker::closePort);
+    connect(this, &DeviceSession::commandRequested, worker, &SerialWorker::enqueueCommand);
+    connect(this, &DeviceSession::cancelModeStepsRequested, worker, &SerialWorker::cancelModeSteps);
+    connect(worker, &SerialWorker::logMessage, this, &DeviceSession::logMessage);
+    connect(worker, &SerialWorker::portOpened, this, [this](bool ok) {
+        opened = ok;
+        emit portOpened(ok);
+    });
+    connect(worker, &SerialWorker::baudRateDetected, this, &DeviceSession::baudRateDetected);
+    connect(worker, &SerialWorker::frameReceived, this, &DeviceSession::onFrameReceived);
+    connect(worker, &SerialWorker::responseTimeout, this, &DeviceSession::responseTimeout);
+    connect(worker, &SerialWorker::heartbeatTimeout, this, [this]() {
+        QMutexLocker locker(&modelMutex);
+        model.reset();   // 下位机可能已断开或重启
+        locker.unlock();
+        emit heartbeatTimeout();
+    });
+    connect(worker, &SerialWorker::commandFinished, this, [this](const QByteArray &frame, bool completed) {
+        QMutexLocker locker(&modelMutex);
+        model.onFinished(reinterpret_cast<const uint8_t*>(frame.constData()), frame.size(), completed);
+        locker.unlock();
+        emit commandFinished(frame, completed);
+    });
+
+    thread->setObjectName(QString("session%1").arg(id));
+    thread->start();
+}
+
+DeviceSession::~DeviceSession()
+{
+    // 串口必须在其所属线程中关闭
+    QMetaObject::invokeMethod(worker, "closePort", Qt::BlockingQueuedConnection);
+    thread->quit();
+    thread->wait();  // 等待线程退出，工作对象随 finished 信号释放
+}
+
+// 先用下位机上报更新设备状态模型，再交给界面处理
+void DeviceSession::onFrameReceived(quint8 command, const QByteArray &data)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data.constData());
+    size_t len = data.size();
+
+    QMutexLocker locker(&modelMutex);
+    if (command == HEARTBEAT && len >= 1 && bytes[0] == 0x00) {
+        model.reset();   // 首次心跳响应：下位机刚上电，之前的状态无效
+    } else if (command == MCU_RESPONSE && len >= offset_BASE) {
+        const DPDescriptor *dp = findDP(bytes[0]);
+        if (dp && len >= static_cast<size_t>(offset_BASE + dp->width)) {
+            model.onReport(dp->id, bytes + offset_BASE);
+        }
+    }
+    locker.unlock();
+
+    emit frameReceived(command, data);
+}
+
+void DeviceSession::open(const QString &portName, const LineSettings &settings)
+{
+    name = portName;
+    {
+        // 上次关闭时仍在发送的指令可能在 close 之后才结束
+        QMutexLocker locker(&modelMutex);
+        model.reset();
+    }
+    emit openPortRequested(portName, settings);
+}
+
+void DeviceSession::close()
+{
+    opened = false;
+    {
+        QMutexLocker locker(&modelMutex);
+        model.reset();
+    }
+    emit closePortRequested();
+}
+
+void DeviceSession::send(const QByteArray &data, const QString &str_log, const QColor &color, CommandPriority priority)
+{
+    QMutexLocker locker(&modelMutex);
+    model.onSent(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+    emit commandRequested(data, str_log, color, priority, 0);
+}
+
+// 持有 modelMutex 时调用：模型记录与入队顺序一致
+void DeviceSession::sendLocked(const uint8_t *frame, size_t len, DPType dp, const QString &str_log, const QColor &color,
+                               CommandPriority priority, quint32 group)
+{
+    // 只发送单个 DP 时在日志中注明
+    QString label = dp == DPType::ALL_STATUS ? str_log : QString("%1 (%2)").arg(str_log, dpDescriptor(dp).name);
+    model.onSent(frame, len);
+    emit commandRequested(QByteArray(reinterpret_cast<const char*>(frame), static_cast<int>(len)), label, color, priority,
+                          group);
+}
+
+void DeviceSession::sendStatus(const AllStatus &target, const QString &str_log, const QColor &color,
+                               CommandPriority priority)
+{
+    QMutexLocker locker(&modelMutex);
+    std::vector<std::vector<uint8_t>> frames;
+    if (model.diff(target, frames) == 0) {
+        emit logMessage(QString("%1：状态未变化，跳过发送").arg(str_log), Qt::gray);
+        return;
+    }
+
+    for (const auto &frame : frames) {
+        sendLocked(frame.data(), frame.size(), static_cast<DPType>(frame[6]), str_log, color, priority);
+    }
+}
+
+ModeBase DeviceSession::baseStatus() const
+{
+    QMutexLocker locker(&modelMutex);
+    const AllStatus &status = model.status();
+    ModeBase base;
+    base.offOn = model.isKnown(DPType::OFF_ON) ? status.offOn : static_cast<uint8_t>(SwitchValue::SWITCH_ON);
+    base.maxChannel = model.isKnown(DPType::MAXCHANNEL) ? status.maxChannel.value() : 0;
+    base.afSelect = model.isKnown(DPType::A_F_SELECT) ? status.afSelect : 0x11;
+    return base;
+}
+
+void DeviceSession::sendModeStep(const ModeStep &step, const QString &str_log, const QColor &color)
+{
+    QMutexLocker locker(&modelMutex);
+    ModeFrameRef frames[DEVICESTATEFIELDCOUNT];
+    size_t count = ModeProgram::selectFrames(step, model, frames);
+    if (count == 0) {
+        emit logMessage(QString("%1：状态未变化，跳过发送").arg(str_log), Qt::gray);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        sendLocked(frames[i].data, frames[i].length, frames[i].dp, str_log, color, CommandPriority::Background,
+                   MODESTEPGROUP);
+    }
+}
+
+void DeviceSession::cancelModeSteps()
+{
+    // 与 commandRequested 进入同一个事件队列，之前入队的模式步骤都会被取消
+    emit cancelModeStepsRequested();
+}
+
+
+SessionManager::SessionManager(CaptureWriter *capture, QObject *parent)
+    : QObject(parent), capture(capture) {
+}
+
+SessionManager::~SessionManager()
+{
+    clear();
+}
+
+DeviceSession *SessionManager::createSession()
+{
+    if (sessionList.size() >= MAXSESSIONS) {
+        return nullptr;
+    }
+
+    // 取最小的空闲编号，抓包文件中按编号区分端口
+    int id = 0;
+    while (session(id)) {
+        ++id;
+    }
+
+    DeviceSession *created = new DeviceSession(id, capture, this);
+    sessionList.append(created);
+    return created;
+}
+
+void SessionManager::removeSession(DeviceSession *session)
+{
+    if (sessionList.removeOne(session)) {
+        delete session;
+    }
+}
+
+void SessionManager::clear()
+{
+    qDeleteAll(sessionList);
+    sessionList.clear();
+}
+
+DeviceSession *SessionManager::session(int id) const
+{
+    for (DeviceSession *session : sessionList) {
+        if (session->id() == id) {
+            return session;
+        }
+    }
+    return nullptr;
+}
+
+void SessionManager::broadcast(const QByteArray &data, const QString &str_log, const QColor &color,
+                               CommandPriority priority)
+{
+    for (DeviceSession *session : sessionList) {
+        if (session->isOpen()) {
+            session->send(data, str_log, color, priority);
+        }
+    }
+}
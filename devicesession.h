@@ -0,0 +1,122 @@
+#ifndef DEVICESESSION_H
+#define DEVICESESSION_H
+
+#include <QObject>
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QColor>
+#include <QVector>
+#include <QMutex>
+
+#include <atomic>
+
+#include "serialworker.h"
+#include "capture.h"
+#include "devicestate.h"
+#include "modeprogram.h"
+
+#define MAXSESSIONS             256      // 同时管理的设备数上限（抓包端口编号为 8 位）
+
+// 单台下位机的界面显示状态，只在界面线程中读写，随下位机上报更新
+// 发送时使用的状态以 DeviceSession::baseStatus()（设备状态模型）为准
+struct DeviceState {
+    uint8_t A_F_Flag = 0x11;      // 通道名称的显示与下拉框内容
+    bool switchStatus = false;    // 开关按钮的显示：true 表示下位机已关机，按下时发送开机
+};
+
+// 设备会话：一台下位机对应一个串口工作对象、一个串口线程和一份设备状态
+// 串口、帧解析、指令队列和定时器都在会话自己的线程中运行，各会话之间互不阻塞
+// send、sendStatus、sendModeStep、cancelModeSteps 可在任意线程调用
+class DeviceSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    DeviceSession(int id, CaptureWriter *capture, QObject *parent = nullptr);
+    ~DeviceSession();
+
+    int id() const { return sessionId; }
+    QString portName() const { return name; }
+    bool isOpen() const { return opened; }
+    DeviceState &state() { return deviceState; }
+
+    void open(const QString &portName, const LineSettings &settings = LineSettings());
+    void close();
+
+    // 将指令交给会话线程排队发送，priority 由调用方按指令来源指定：
+    // STOP、关机为 Safety，面板操作与复位为 Interactive，模式步骤、查询为 Background
+    void send(const QByteArray &data, const QString &str_log, const QColor &color, CommandPriority priority);
+    // 把下位机改为目标状态：只发送与设备状态模型不同的 DP，状态一致时不发送
+    void sendStatus(const AllStatus &target, const QString &str_log, const QColor &color, CommandPriority priority);
+    // 设备状态模型中的开关状态、最大频道值和 A/F 类型，复位与模式编译以此为基准
+    // 未知的项取默认值：开机、0、未知类型（0x11）
+    ModeBase baseStatus() const;
+    // 发送编译好的模式步骤：规则同 sendStatus，直接使用预编码的帧，按 Background 发送
+    void sendModeStep(const ModeStep &step, const QString &str_log, const QColor &color);
+    // 取消会话线程中尚未发送的模式步骤；之后入队的指令排在取消之后，不会被模式步骤超越
+    void cancelModeSteps();
+
+signals:
+    void logMessage(const QString &text, const QColor &color);
+    void portOpened(bool ok);
+    void baudRateDetected(qint32 baudRate);
+    void frameReceived(quint8 command, const QByteArray &data);
+    void responseTimeout();
+    void heartbeatTimeout();
+    void commandFinished(const QByteArray &frame, bool completed);
+
+    // 发往会话线程的请求
+    void openPortRequested(const QString &portName, const LineSettings &settings);
+    void closePortRequested();
+    void commandRequested(const QByteArray &data, const QString &str_log, const QColor &color,
+                          CommandPriority priority, quint32 group);
+    void cancelModeStepsRequested();
+
+private:
+    void onFrameReceived(quint8 command, const QByteArray &data);
+    void sendLocked(const uint8_t *frame, size_t len, DPType dp, const QString &str_log, const QColor &color,
+                    CommandPriority priority, quint32 group = 0);
+
+    int sessionId;
+    QString name;
+    std::atomic<bool> opened{false};
+    DeviceState deviceState;
+
+    // 下位机上报与已确认指令构成的状态，发送时只发差异
+    // 模式执行器在自己的线程中发送，模型的读写都需持有 modelMutex
+    DeviceStateModel model;
+    mutable QMutex modelMutex;
+
+    QThread *thread;             // 会话线程
+    SerialWorker *worker;        // 串口工作对象，属于 thread
+};
+
+// 会话管理：一个进程同时驱动多台下位机
+// 每个会话有独立的线程，总指令吞吐量随串口数增加
+class SessionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionManager(CaptureWriter *capture = nullptr, QObject *parent = nullptr);
+    ~SessionManager();
+
+    // 新建会话，会话数已达上限时返回 nullptr
+    DeviceSession *createSession();
+    void removeSession(DeviceSession *session);
+    // 关闭并释放全部会话
+    void clear();
+
+    DeviceSession *session(int id) const;
+    const QVector<DeviceSession*> &sessions() const { return sessionList; }
+
+    // 向所有已打开的会话发送同一条指令
+    void broadcast(const QByteArray &data, const QString &str_log, const QColor &color, CommandPriority priority);
+
+private:
+    CaptureWriter *capture;
+    QVector<DeviceSession*> sessionList;
+};
+
+#endif // DEVICESESSION_H
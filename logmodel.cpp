@@ -0,0 +1,119 @@
+#include "logmodel.h"
+
+#include <QBrush>
+
+LogModel::LogModel(int maxLines, QObject *parent)
+    : QAbstractListModel(parent),
+    entries(maxLines > 0 ? maxLines : 1),
+    capacity(entries.size()),
+    flushTimer(new QTimer(this))
+{
+    // 合并刷新：一个刷新间隔内的所有追加只触发一次行插入
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(LOGREFRESHINTERVAL);
+    connect(flushTimer, &QTimer::timeout, this, &LogModel::flush);
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= count) {
+        return QVariant();
+    }
+
+    const Entry &entry = at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return entry.text;
+        case Qt::ForegroundRole:
+            return QBrush(entry.color);
+        default:
+            return QVariant();
+    }
+}
+
+void LogModel::append(const QString &text, const QColor &color)
+{
+    pending.append({text, color});
+
+    // 待刷新列表同样受容量限制
+    if (pending.size() > capacity) {
+        pending.remove(0, pending.size() - capacity);
+    }
+
+    if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+}
+
+void LogModel::flush()
+{
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    int incoming = pending.size();
+    if (incoming >= capacity) {
+        // 新日志已填满容量，直接替换全部内容
+        beginResetModel();
+        for (int i = 0; i < capacity; ++i) {
+            entries[i] = pending[incoming - capacity + i];
+        }
+        head = 0;
+        count = capacity;
+        endResetModel();
+    }
+    else {
+        // 先丢弃最旧的行，再在末尾插入
+        int overflow = count + incoming - capacity;
+        if (overflow > 0) {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            head = (head + overflow) % capacity;
+            count -= overflow;
+            endRemoveRows();
+        }
+
+        beginInsertRows(QModelIndex(), count, count + incoming - 1);
+        for (const Entry &entry : pending) {
+            entries[(head + count) % capacity] = entry;
+            ++count;
+        }
+        endInsertRows();
+    }
+
+    pending.clear();
+    emit flushed();
+}
+
+void LogModel::setMaxLines(int maxLines)
+{
+    if (maxLines < 1 || maxLines == capacity) {
+        return;
+    }
+
+    // 保留最新的 maxLines 行
+    beginResetModel();
+    int keep = qMin(count, maxLines);
+    QVector<Entry> resized(maxLines);
+    for (int i = 0; i < keep; ++i) {
+        resized[i] = at(count - keep + i);
+    }
+    entries.swap(resized);
+    capacity = maxLines;
+    head = 0;
+    count = keep;
+    endResetModel();
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    head = 0;
+    count = 0;
+    pending.clear();
+    endResetModel();
+}
@@ -0,0 +1,51 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QColor>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#define LOGMAXLINES             5000     // 日志视图保留的最大行数
+#define LOGREFRESHINTERVAL      16       // 日志视图刷新间隔（毫秒），每个间隔最多刷新一次
+
+// 日志模型：固定容量的环形缓冲区，超出容量时丢弃最旧的行
+// 追加的日志先进入待刷新列表，由定时器合并后一次性插入，视图每个刷新间隔最多重绘一次
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogModel(int maxLines = LOGMAXLINES, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void append(const QString &text, const QColor &color);
+    void setMaxLines(int maxLines);
+    int maxLines() const { return capacity; }
+    void clear();
+
+signals:
+    void flushed();   // 待刷新的日志已插入模型
+
+private:
+    struct Entry {
+        QString text;
+        QColor color;
+    };
+
+    void flush();
+    const Entry &at(int row) const { return entries[(head + row) % capacity]; }
+
+    QVector<Entry> entries;      // 环形缓冲区
+    int capacity;
+    int head = 0;                // 最旧一行在 entries 中的位置
+    int count = 0;
+
+    QVector<Entry> pending;      // 等待刷新的日志
+    QTimer *flushTimer;
+};
+
+#endif // LOGMODEL_H
@@ -0,0 +1,195 @@
+#include "logsink.h"
+#include "fileutil.h"
+
+#include <chrono>
+
+LogRecordQueue::LogRecordQueue(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    cells.reset(new Cell[size]);
+    mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    enqueuePos.store(0, std::memory_order_relaxed);
+    dequeuePos.store(0, std::memory_order_relaxed);
+}
+
+bool LogRecordQueue::push(std::string &&record)
+{
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占入队位置
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 队列已满
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->data = std::move(record);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRecordQueue::pop(std::string &record)
+{
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 队列为空
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    record = std::move(cell->data);
+    cell->data.clear();
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+
+LogSink::LogSink()
+    : queue(LOGSINKQUEUESIZE), running(false), dropped(0) {
+}
+
+LogSink::~LogSink()
+{
+    stop();
+}
+
+bool LogSink::start(const std::string &dir, const std::string &name)
+{
+    if (running.load()) {
+        return true;
+    }
+
+    directory = dir;
+    baseName = name;
+    if (!openFile()) {
+        return false;
+    }
+
+    running.store(true);
+    writer = std::thread(&LogSink::run, this);
+    return true;
+}
+
+void LogSink::stop()
+{
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    // 后台线程退出前写完队列中剩余的日志
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void LogSink::write(std::string line)
+{
+    line += '\n';
+    if (!queue.push(std::move(line))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string LogSink::filePath(int index) const
+{
+    if (index == 0) {
+        return directory + "/" + baseName + ".log";
+    }
+    return directory + "/" + baseName + "." + std::to_string(index) + ".log";
+}
+
+bool LogSink::openFile()
+{
+    file = fopenUtf8(filePath(0), "ab");
+    if (!file) {
+        return false;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    fileSize = size > 0 ? static_cast<size_t>(size) : 0;
+    fileOpenedAt = std::time(nullptr);
+    return true;
+}
+
+// 轮转：删除最旧的文件，其余文件序号依次加一，再新建当前文件
+void LogSink::rotate()
+{
+    std::fclose(file);
+    file = nullptr;
+
+    removeUtf8(filePath(LOGFILEMAXCOUNT));
+    for (int i = LOGFILEMAXCOUNT - 1; i >= 0; --i) {
+        renameUtf8(filePath(i), filePath(i + 1));
+    }
+
+    openFile();
+}
+
+void LogSink::run()
+{
+    std::string batch;
+    std::string record;
+
+    for (;;) {
+        bool stopping = !running.load();
+
+        // 取出队列中的全部日志，合并为一次写入
+        batch.clear();
+        while (queue.pop(record)) {
+            batch += record;
+        }
+
+        uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+        if (droppedNow != reportedDropped) {
+            batch += "[LogSink] 日志队列已满，丢弃 " + std::to_string(droppedNow - reportedDropped) + " 条日志\n";
+            reportedDropped = droppedNow;
+        }
+
+        if (!batch.empty() && file) {
+            std::fwrite(batch.data(), 1, batch.size(), file);
+            std::fflush(file);
+            fileSize += batch.size();
+
+            if (fileSize >= LOGFILEMAXSIZE
+                || std::difftime(std::time(nullptr), fileOpenedAt) >= LOGFILEROTATEHOURS * 3600.0) {
+                rotate();
+            }
+        }
+
+        if (stopping) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOGSINKFLUSHINTERVAL));
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+
+#define LOGSINKQUEUESIZE        8192     // 日志文件队列容量（2的幂），队列满时丢弃新日志
+#define LOGSINKFLUSHINTERVAL    200      // 后台线程批量写盘间隔（毫秒）
+#define LOGFILEMAXSIZE          (10 * 1024 * 1024)   // 单个日志文件大小上限，超过后轮转
+#define LOGFILEROTATEHOURS      24       // 单个日志文件时间上限（小时），超过后轮转
+#define LOGFILEMAXCOUNT         10       // 保留的历史日志文件数
+
+// 无锁有界队列（多生产者多消费者，基于每个槽位的序号）
+// 生产者入队不加锁、不阻塞，队列满时返回 false
+class LogRecordQueue {
+public:
+    explicit LogRecordQueue(size_t capacity);
+
+    bool push(std::string &&record);
+    bool pop(std::string &record);
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        std::string data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    std::atomic<size_t> enqueuePos;
+    std::atomic<size_t> dequeuePos;
+};
+
+// 异步日志文件输出
+// 调用线程只把日志推入无锁队列；后台线程按间隔批量写入文件，
+// 按大小和时间轮转：elevator.log -> elevator.1.log -> ... -> elevator.N.log
+// 写入后只 fflush 到系统缓存，不逐行 fsync
+class LogSink {
+public:
+    LogSink();
+    ~LogSink();
+
+    bool start(const std::string &directory, const std::string &baseName = "elevator");
+    void stop();
+
+    // 推入一条日志（不含换行），不阻塞
+    void write(std::string line);
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    bool openFile();
+    void rotate();
+    std::string filePath(int index) const;
+
+    LogRecordQueue queue;
+    std::thread writer;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> dropped;
+
+    // 以下成员只在后台线程中访问
+    std::string directory;
+    std::string baseName;
+    std::FILE *file = nullptr;
+    size_t fileSize = 0;
+    std::time_t fileOpenedAt = 0;
+    uint64_t reportedDropped = 0;
+};
+
+#endif // LOGSINK_H
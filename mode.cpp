@@ -9,6 +9,26 @@
 #include <QTableWidget>
 #include <QDir>
 
+#define MODEMAXDELAYMS          (65535u * 1000u)    // 单步延时上限
+
+// 延时列：秒，可带小数（如 0.25）；以 ms 结尾时为毫秒（如 250ms）
+static bool parseDelayMs(const QString &text, uint32_t &delayMs) {
+    QString value = text.trimmed();
+    double scale = 1000.0;
+    if (value.endsWith("ms", Qt::CaseInsensitive)) {
+        value.chop(2);
+        scale = 1.0;
+    }
+
+    bool ok;
+    double delay = value.trimmed().toDouble(&ok) * scale;
+    if (!ok || delay < 0 || delay > MODEMAXDELAYMS) {
+        return false;
+    }
+    delayMs = static_cast<uint32_t>(delay + 0.5);   // 四舍五入到毫秒
+    return true;
+}
+
 
 TableEditor::TableEditor(const QString &filePath, QWidget *parent)
     : QDialog(parent), filePath(filePath), loop_count(0) {
@@ -17,7 +37,7 @@ TableEditor::TableEditor(const QString &filePath, QWidget *parent)
 
     // 表格初始化
     tableWidget = new QTableWidget(1, 4, this); // 默认 1 行 4 列
-    tableWidget->setHorizontalHeaderLabels({"通道", "频道", "控制", "延时"});
+    tableWidget->setHorizontalHeaderLabels({"通道", "频道", "控制", "延时(秒)"});
     tableWidget->horizontalHeader()->setStretchLastSection(true);
 
     // 按钮初始化
@@ -207,64 +227,32 @@ bool TableEditor::validateTableData(Widget *logWidget) {
             continue;  // 跳过当前行，继续检查下一行
         }
 
-        // 获取第一列的数据，并检查是否为 StringAccessValueMap 中的键
+        // 获取第一列的数据，并检查是否为有效的通道值
         QString firstColValue = tableWidget->item(row, 0)->text().trimmed();
-        if (StringAccessValueMap.find(firstColValue.toStdString()) == StringAccessValueMap.end()) {
+        uint8_t accessValue;
+        if (!findAccessValue(nameEquals(firstColValue), accessValue)) {
             logWidget->appendLog("错误：第" + QString::number(row + 1) + "行的第一列数据 \"" + firstColValue +
-                                 "\" 不是有效的 StringAccessValueMap 键!");
+                                 "\" 不是有效的通道值!");
             hasError = true;
         }
-        if (logWidget->A_F_Flag == static_cast<uint8_t>(AFSelectValue::AFSelect_A)) {
-            // 检查 firstColValue 是否在 ADAccessValueMap 的值中
-            bool isValidADAccessValue = false;
-            for (const auto& pair : ADAccessValueMap) {
-                if (pair.second == firstColValue) {  // 比较 QString 值
-                    isValidADAccessValue = true;
-                    break;
-                }
-            }
-
-            if (!isValidADAccessValue) {
-                logWidget->appendLog("错误：第一列数据 \"" + firstColValue + "\" 不是此上位机的值!");
-                return true; // 验证失败
-            }
+        // 检查 firstColValue 是否为当前下位机类型（A/F）的通道
+        ValueNameTable accessNames = accessValueNames(logWidget->currentSession()->baseStatus().afSelect);
+        if (accessNames.count > 0 && !accessNames.find(nameEquals(firstColValue), accessValue)) {
+            logWidget->appendLog("错误：第一列数据 \"" + firstColValue + "\" 不是此上位机的值!");
+            return true; // 验证失败
         }
-        else if (logWidget->A_F_Flag == static_cast<uint8_t>(AFSelectValue::AFSelect_F)) {
-            // 检查 firstColValue 是否在 FAccessValueMap 的值中
-            bool isValidFAccessValue = false;
-            for (const auto& pair : FAccessValueMap) {
-                if (pair.second == firstColValue) {  // 比较 QString 值
-                    isValidFAccessValue = true;
-                    break;  // 找到匹配值后直接退出循环
-                }
-            }
 
-            if (!isValidFAccessValue) {
-                logWidget->appendLog("错误：第一列数据 \"" + firstColValue + "\" 不是此上位机的值!");
-                return true; // 验证失败
-            }
-        }
 
-
-        // 获取第三列的数据，并检查是否为 DevCtrlValueMap 中的键
+        // 获取第三列的数据，并检查是否为有效的设备控制值
         QString thirdColValue = tableWidget->item(row, 2)->text().trimmed();
-        bool isValidDevCtrlValue = false;
-
-        // 检查 thirdColValue 是否在 DevCtrlValueMap 中
-        for (const auto& pair : DevCtrlValueMap) {
-            if (pair.second == thirdColValue) {
-                isValidDevCtrlValue = true;
-                break;
-            }
-        }
-
-        if (!isValidDevCtrlValue) {
+        uint8_t devCtrlValue;
+        if (!DevCtrlValueNames.find(nameEquals(thirdColValue), devCtrlValue)) {
             logWidget->appendLog("错误：第" + QString::number(row + 1) + "行的第三列数据 \"" + thirdColValue +
-                                 "\" 不是有效的 DevCtrlValueMap 键!");
+                                 "\" 不是有效的设备控制值!");
             hasError = true;
         }
 
-        // 检查第二列和第四列是否是小于 65536 的自然数
+        // 检查第二列是否是小于 65536 的自然数
         bool ok;
         uint16_t secondColValue = tableWidget->item(row, 1)->text().trimmed().toUInt(&ok);
         if (!ok || secondColValue >= 0xffff) {
@@ -273,10 +261,11 @@ bool TableEditor::validateTableData(Widget *logWidget) {
             hasError = true;
         }
 
-        uint16_t fourthColValue = tableWidget->item(row, 3)->text().trimmed().toUInt(&ok);
-        if (!ok || fourthColValue >= 0xffff) {
+        // 检查第四列是否是有效的延时（秒，可带小数，或以 ms 结尾的毫秒数）
+        uint32_t delayMs;
+        if (!parseDelayMs(tableWidget->item(row, 3)->text(), delayMs)) {
             logWidget->appendLog("错误：第" + QString::number(row + 1) + "行的第四列数据 \"" +
-                                 tableWidget->item(row, 3)->text() + "\" 不是有效的小于 65536 的自然数!");
+                                 tableWidget->item(row, 3)->text() + "\" 不是有效的延时（秒，可带小数，或如 250ms）!");
             hasError = true;
         }
     }
@@ -320,95 +309,75 @@ void Widget::execOrCreateTable(const QString &fileName, std::function<void()> pF
     }
     else {
         editor.printTableDataToLog(this);
-        editor.sendTableData(this);
+
+        // 编译后交给模式执行器，在执行器线程中按时间线发送，此处立即返回
+        ModeProgram program;
+        if (!editor.compileTableData(this, program)) {
+            setColor();
+            return; // 停止发送
+        }
+        modeExecutor->start(session, program);
     }
 
 }
 
-void TableEditor::sendTableData(Widget *logWidget) {
-    logWidget->stopRequested = false; // 每次开始执行时重置
-    std::vector<uint8_t> allStatusData(8);
-    for (int loop = 0; loop < loop_count; ++loop) {
-        if (logWidget->stopRequested) {
-            logWidget->appendLog("发送操作模式已被停止。", Qt::gray);
-            return; // 提前退出函数
-        }
-        // 遍历每一行
-        for (int row = 0; row < tableWidget->rowCount(); ++row) {
-            try {
-                if (logWidget->stopRequested) {
-                    logWidget->appendLog("发送操作模式已被停止。", Qt::gray);
-                    return; // 提前退出函数
-                }
-                // 1、开关状态
-                allStatusData[offset_OFF_ON] = logWidget->switchStatus
-                                                   ? static_cast<uint8_t>(SwitchValue::SWITCH_OFF)
-                                                   : static_cast<uint8_t>(SwitchValue::SWITCH_ON);
-
-                // 2、通道
-                QString valueAccess = tableWidget->item(row, 0)->text();
-                if (valueAccess.isEmpty()) throw std::runtime_error("通道字段为空！");
-                auto it = StringAccessValueMap.find(valueAccess.toStdString());
-                if (it != StringAccessValueMap.end()) {
-                    allStatusData[offset_ACCESS_SELECT] = it->second;
-                } else {
-                    throw std::runtime_error("表格内出现非通道字字段！");
-                }
-
-                // 3、最大频道值
-                allStatusData[offset_MAXCHANNEL] = (logWidget->maxChannelNumber >> 8) & 0xFF;  // 高字节
-                allStatusData[offset_MAXCHANNEL + 1] = logWidget->maxChannelNumber & 0xFF;    // 低字节
-
-                // 4、频道值
-                QString channelText = tableWidget->item(row, 1)->text();
-                if (channelText.isEmpty()) throw std::runtime_error("频道值为空！");
-                uint32_t valueChannel = channelText.toInt();
-                allStatusData[offset_CHANNEL] = (valueChannel >> 8) & 0xFF;  // 高字节
-                allStatusData[offset_CHANNEL + 1] = valueChannel & 0xFF;     // 低字节
-
-                // 5、设备控制
-                QString valueCtrl = tableWidget->item(row, 2)->text();
-                if (valueCtrl.isEmpty()) throw std::runtime_error("设备控制字段为空！");
-                auto its = StringDevCtrlValueMap.find(valueCtrl.toStdString());
-                if (its != StringDevCtrlValueMap.end()) {
-                    allStatusData[offset_POSITION_CONTROL] = static_cast<uint8_t>(its->second);
-                } else {
-                    throw std::runtime_error("表格内出现非设备控制字段！");
-                }
-
-                // 6、A/F状态
-                allStatusData[offset_A_F_SELECT] = logWidget->A_F_Flag;
-
-                // 发送 allStatus
-                ProtocolFrame allStatusDataFrame = createDeviceControlFrame(DPType::ALL_STATUS, allStatusData);
-                logWidget->sendFrame(allStatusDataFrame, QString("发送 allStatus: Row %1").arg(row));
-
-                // 延时（非阻塞）
-                QString delayText = tableWidget->item(row, 3)->text();
-                if (delayText.isEmpty()) throw std::runtime_error("延时时间为空！");
-                uint32_t delayTime = delayText.toUInt();
-                QEventLoop loop;
-                QTimer::singleShot(delayTime * 1000, &loop, &QEventLoop::quit);
-                connect(logWidget, &Widget::stopLoopSignal, &loop, &QEventLoop::quit);
-                loop.exec();
-
-                if (logWidget->stopRequested) {
-                    logWidget->appendLog("发送操作模式已被停止。", Qt::gray);
-                    return; // 提前退出函数
-                }
-            } catch (const std::runtime_error &e) {
-                QMessageBox::critical(this, "错误提示", QString("行 %1: %2").arg(row).arg(e.what()));
-                logWidget->appendLog(QString("Error (Row %1): %2").arg(row).arg(e.what()), Qt::red);
-                logWidget->setColor();
-                return; // 停止发送
+// 执行前一次性解析表格并编码所有帧，执行过程中不再读取表格
+bool TableEditor::compileTableData(Widget *logWidget, ModeProgram &program) {
+    // 表格单元格文本，为空时抛出异常
+    auto cellText = [this](int row, int col, const char *emptyError) {
+        QTableWidgetItem *item = tableWidget->item(row, col);
+        QString text = item ? item->text().trimmed() : QString();
+        if (text.isEmpty()) throw std::runtime_error(emptyError);
+        return text;
+    };
+
+    std::vector<ModeRow> rows;
+    rows.reserve(tableWidget->rowCount());
+    for (int row = 0; row < tableWidget->rowCount(); ++row) {
+        try {
+            ModeRow modeRow = {};
+
+            // 1、通道
+            if (!findAccessValue(nameEquals(cellText(row, 0, "通道字段为空！")), modeRow.accessSelect)) {
+                throw std::runtime_error("表格内出现非通道字字段！");
+            }
+
+            // 2、频道值
+            modeRow.channel = static_cast<uint16_t>(cellText(row, 1, "频道值为空！").toInt());
+
+            // 3、设备控制
+            if (!DevCtrlValueNames.find(nameEquals(cellText(row, 2, "设备控制字段为空！")), modeRow.positionControl)) {
+                throw std::runtime_error("表格内出现非设备控制字段！");
             }
+
+            // 4、延时
+            if (!parseDelayMs(cellText(row, 3, "延时时间为空！"), modeRow.delayMs)) {
+                throw std::runtime_error("延时时间无效！");
+            }
+
+            rows.push_back(modeRow);
+        } catch (const std::runtime_error &e) {
+            QMessageBox::critical(this, "错误提示", QString("行 %1: %2").arg(row).arg(e.what()));
+            logWidget->appendLog(QString("Error (Row %1): %2").arg(row).arg(e.what()), Qt::red);
+            return false;
         }
     }
-    logWidget->appendLog("发送模式结束。", Qt::gray);
-    logWidget->setColor();
-    logWidget->stopRequested = true; // 每次模式执行结束时重置
-}
 
+    // 开关状态、最大频道值、A/F状态取编译时设备状态模型中的值
+    ModeBase base = logWidget->currentSession()->baseStatus();
+
+    size_t errorRow = 0;
+    std::string error;
+    if (!ModeProgram::compile(base, rows, static_cast<uint32_t>(qMax(loop_count, 0)), program, errorRow, error)) {
+        QString message = QString::fromStdString(error);
+        QMessageBox::critical(this, "错误提示", QString("行 %1: %2").arg(errorRow).arg(message));
+        logWidget->appendLog(QString("Error (Row %1): %2").arg(errorRow).arg(message), Qt::red);
+        return false;
+    }
+
+    logWidget->appendLog(QString("模式编译完成：%1 步，循环 %2 次").arg(program.size()).arg(program.loopCount()), Qt::gray);
+    return true;
+}
 
 bool Widget::eventFilter(QObject *watched, QEvent *event)
 {
@@ -452,14 +421,13 @@ void Widget::on_mode01Bt_clicked()
 {
     if (ui->mode01Bt->styleSheet().contains("lightgreen")) {
         ui->mode01Bt->setStyleSheet("background-color: lightgray;");
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
         appendLog("模式1已被主动停止！");
     }
     else {
-        if (!stopRequested) {
+        if (modeExecutor->isActive()) {
             appendLog("当前正在执行其它模式.......请停止当前模式后重试", Qt::red);
             QMessageBox::critical(this, "错误提示", "当前正在执行其它模式.......请停止当前模式后重试");
             return; // 提前退出函数
@@ -480,14 +448,13 @@ void Widget::on_mode02Bt_clicked()
 {
     if (ui->mode02Bt->styleSheet().contains("lightgreen")) {
         ui->mode02Bt->setStyleSheet("background-color: lightgray;");
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
         appendLog("模式2已被主动停止！");
     }
     else {
-        if (!stopRequested) {
+        if (modeExecutor->isActive()) {
             appendLog("当前正在执行其它模式.......请停止当前模式后重试", Qt::red);
             QMessageBox::critical(this, "错误提示", "当前正在执行其它模式.......请停止当前模式后重试");
             return;
@@ -508,14 +475,13 @@ void Widget::on_mode03Bt_clicked()
 {
     if (ui->mode03Bt->styleSheet().contains("lightgreen")) {
         ui->mode03Bt->setStyleSheet("background-color: lightgray;");
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
         appendLog("模式3已被主动停止！");
     }
     else {
-        if (!stopRequested) {
+        if (modeExecutor->isActive()) {
             appendLog("当前正在执行其它模式.......请停止当前模式后重试", Qt::red);
             QMessageBox::critical(this, "错误提示", "当前正在执行其它模式.......请停止当前模式后重试");
             return;
@@ -536,14 +502,13 @@ void Widget::on_mode04Bt_clicked()
 {
     if (ui->mode04Bt->styleSheet().contains("lightgreen")) {
         ui->mode04Bt->setStyleSheet("background-color: lightgray;");
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
         appendLog("模式4已被主动停止！");
     }
     else {
-        if (!stopRequested) {
+        if (modeExecutor->isActive()) {
             appendLog("当前正在执行其它模式.......请停止当前模式后重试", Qt::red);
             QMessageBox::critical(this, "错误提示", "当前正在执行其它模式.......请停止当前模式后重试");
             return;
@@ -564,14 +529,13 @@ void Widget::on_mode05Bt_clicked()
 {
     if (ui->mode05Bt->styleSheet().contains("lightgreen")) {
         ui->mode05Bt->setStyleSheet("background-color: lightgray;");
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
         appendLog("模式5已被主动停止！");
     }
     else {
-        if (!stopRequested) {
+        if (modeExecutor->isActive()) {
             appendLog("当前正在执行其它模式.......请停止当前模式后重试", Qt::red);
             QMessageBox::critical(this, "错误提示", "当前正在执行其它模式.......请停止当前模式后重试");
             return;
@@ -592,14 +556,13 @@ void Widget::on_mode06Bt_clicked()
 {
     if (ui->mode06Bt->styleSheet().contains("lightgreen")) {
         ui->mode06Bt->setStyleSheet("background-color: lightgray;");
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
         appendLog("模式6已被主动停止！");
     }
     else {
-        if (!stopRequested) {
+        if (modeExecutor->isActive()) {
             appendLog("当前正在执行其它模式.......请停止当前模式后重试", Qt::red);
             QMessageBox::critical(this, "错误提示", "当前正在执行其它模式.......请停止当前模式后重试");
             return;
@@ -0,0 +1,186 @@
+#include "modeexecutor.h"
+#include "devicesession.h"
+
+#include <QColor>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <chrono>
+
+ModeRunner::ModeRunner(QObject *parent)
+    : QObject(parent),
+    timer(new QTimer(this))
+{
+    // 子对象随工作对象一起移动到执行器线程
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &ModeRunner::tick);
+}
+
+ModeReport ModeRunner::report() const
+{
+    const ModeTimeline::Lateness &lateness = timeline.lateness();
+    ModeReport result;
+    result.steps = lateness.steps;
+    result.lateSteps = lateness.lateSteps;
+    result.skippedSteps = lateness.skipped;
+    result.maxLateMs = lateness.max.count() / 1000.0;
+    result.meanLateMs = lateness.steps ? lateness.total.count() / 1000.0 / lateness.steps : 0.0;
+    return result;
+}
+
+// 发送到期的步骤（已被后续到期步骤取代的跳过），再把定时器对准下一个计划时刻；定时器提前唤醒时只重新对准
+void ModeRunner::tick()
+{
+    QMutexLocker locker(&control);
+    if (state != ModeState::Running) {
+        timer->stop();   // 已停止或暂停，恢复时重新唤醒
+        return;
+    }
+    if (!session->isOpen()) {
+        state = ModeState::Idle;   // 串口已关闭，按停止处理
+        emit finished(generation, false, report());
+        return;
+    }
+
+    auto rearm = [this](ModeTimeline::Clock::time_point deadline) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - ModeTimeline::Clock::now());
+        timer->start(static_cast<int>(std::max<qint64>(0, remaining.count())));
+    };
+
+    while (!timeline.done()) {
+        if (ModeTimeline::Clock::now() < timeline.deadline()) {
+            rearm(timeline.deadline());
+            return;
+        }
+
+        // 落后超过一步时只发送最后一个到期的步骤，补发量有上限
+        timeline.skipSuperseded(ModeTimeline::Clock::now());
+
+        quint32 loop = timeline.loop();
+        size_t index = timeline.step();
+        const ModeStep &step = program[index];
+        // 发送目标状态中与当前设备状态不同的部分
+        session->sendModeStep(step, labels[static_cast<int>(index)], Qt::black);
+
+        std::chrono::microseconds late = timeline.advance(ModeTimeline::Clock::now());
+        emit progress(loop, static_cast<int>(index), step.row);
+        if (late >= std::chrono::milliseconds(MODELATEWARNMS)) {
+            emit stepLate(loop, step.row, late.count() / 1000.0);
+        }
+    }
+
+    // 最后一步的延时
+    if (ModeTimeline::Clock::now() < timeline.endTime()) {
+        rearm(timeline.endTime());
+        return;
+    }
+
+    state = ModeState::Idle;
+    emit finished(generation, true, report());
+}
+
+
+ModeExecutor::ModeExecutor(QObject *parent)
+    : QObject(parent),
+    thread(new QThread(this)),
+    runner(new ModeRunner)
+{
+    qRegisterMetaType<ModeReport>();
+
+    // 工作对象移动到执行器线程，界面线程只通过 control 与排队调用控制它
+    runner->moveToThread(thread);
+    connect(thread, &QThread::finished, runner, &QObject::deleteLater);
+    connect(runner, &ModeRunner::progress, this, &ModeExecutor::progress);
+    connect(runner, &ModeRunner::stepLate, this, &ModeExecutor::stepLate);
+    connect(runner, &ModeRunner::finished, this, [this](quint64 generation, bool completed, const ModeReport &report) {
+        QMutexLocker locker(&runner->control);
+        bool current = generation == runner->generation && runner->state == ModeState::Idle;
+        locker.unlock();
+        if (current) {
+            emit stateChanged(ModeState::Idle);
+            emit finished(completed, report);
+        }
+    });
+
+    thread->setObjectName("mode");
+    thread->start();
+}
+
+ModeExecutor::~ModeExecutor()
+{
+    stop();
+    thread->quit();
+    thread->wait();  // 等待线程退出，工作对象随 finished 信号释放
+}
+
+bool ModeExecutor::start(DeviceSession *session, const ModeProgram &program)
+{
+    // 每步的日志标签只生成一次
+    QStringList labels;
+    labels.reserve(static_cast<int>(program.size()));
+    for (const ModeStep &step : program.steps()) {
+        labels.append(QString("发送 allStatus: Row %1").arg(step.row));
+    }
+
+    QMutexLocker locker(&runner->control);
+    if (runner->state != ModeState::Idle) {
+        return false;
+    }
+    runner->session = session;
+    runner->program = program;
+    runner->labels = labels;
+    runner->timeline = ModeTimeline(runner->program);
+    runner->timeline.start(ModeTimeline::Clock::now());
+    ++runner->generation;
+    runner->state = ModeState::Running;
+    locker.unlock();
+
+    emit stateChanged(ModeState::Running);
+    QMetaObject::invokeMethod(runner, "tick", Qt::QueuedConnection);
+    return true;
+}
+
+void ModeExecutor::pause()
+{
+    QMutexLocker locker(&runner->control);
+    if (runner->state != ModeState::Running) {
+        return;
+    }
+    runner->timeline.pause(ModeTimeline::Clock::now());
+    runner->state = ModeState::Paused;
+    locker.unlock();
+
+    emit stateChanged(ModeState::Paused);
+}
+
+void ModeExecutor::resume()
+{
+    QMutexLocker locker(&runner->control);
+    if (runner->state != ModeState::Paused) {
+        return;
+    }
+    runner->timeline.resume(ModeTimeline::Clock::now());
+    runner->state = ModeState::Running;
+    locker.unlock();
+
+    emit stateChanged(ModeState::Running);
+    QMetaObject::invokeMethod(runner, "tick", Qt::QueuedConnection);
+}
+
+// 持有 control 时改为空闲，执行器线程正在发送的步骤发送完之后才返回；
+// 已交给会话但尚未发送的步骤随后取消，之后发送的复位指令不会被旧步骤覆盖
+void ModeExecutor::stop()
+{
+    QMutexLocker locker(&runner->control);
+    if (runner->state == ModeState::Idle) {
+        return;
+    }
+    runner->state = ModeState::Idle;
+    runner->session->cancelModeSteps();
+    ModeReport report = runner->report();
+    locker.unlock();
+
+    emit stateChanged(ModeState::Idle);
+    emit finished(false, report);
+}
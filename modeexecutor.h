@@ -0,0 +1,103 @@
+#ifndef MODEEXECUTOR_H
+#define MODEEXECUTOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+
+#include "modeprogram.h"
+#include "modetimeline.h"
+
+class DeviceSession;
+
+// 模式执行状态
+enum class ModeState : int {
+    Idle,       // 未执行
+    Running,    // 按时间线发送
+    Paused      // 暂停，时间线整体后移
+};
+
+// 模式执行的时间线统计，执行结束时随 finished 信号发出
+struct ModeReport {
+    quint64 steps = 0;
+    quint64 lateSteps = 0;
+    quint64 skippedSteps = 0;   // 落后时被后续步骤取代、未发送的步数
+    double maxLateMs = 0;
+    double meanLateMs = 0;
+};
+Q_DECLARE_METATYPE(ModeReport)
+
+// 模式执行的工作对象，属于执行器线程
+// 每次唤醒只处理到期的步骤，随后把定时器对准下一步的计划时刻，不嵌套事件循环
+class ModeRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModeRunner(QObject *parent = nullptr);
+
+public slots:
+    void tick();
+
+signals:
+    void progress(quint32 loop, int step, int row);
+    void stepLate(quint32 loop, int row, double lateMs);
+    void finished(quint64 generation, bool completed, const ModeReport &report);
+
+private:
+    friend class ModeExecutor;
+
+    ModeReport report() const;
+
+    QTimer *timer;       // 对准下一步计划时刻的单次定时器
+
+    // 以下成员由 control 保护，界面线程的控制请求与本线程的发送互斥
+    QMutex control;
+    std::atomic<ModeState> state{ModeState::Idle};
+    quint64 generation = 0;         // 每次启动加一，用于丢弃上一次执行迟到的结束通知
+    DeviceSession *session = nullptr;
+    ModeProgram program;
+    QStringList labels;
+    ModeTimeline timeline{program};
+};
+
+// 模式执行器：在独立线程中按时间线发送编译好的模式程序
+// start/pause/resume/stop 可在界面线程中随时调用且立即返回；stop 返回后不会再发出任何步骤，
+// 会话中已排队、尚未发送的步骤也被取消，之后可以立即发送复位指令。
+// 同一时刻只执行一个程序，执行中再次 start 返回 false。
+class ModeExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModeExecutor(QObject *parent = nullptr);
+    ~ModeExecutor();
+
+    bool start(DeviceSession *session, const ModeProgram &program);
+    void pause();
+    void resume();
+    void stop();
+
+    ModeState state() const { return runner->state.load(); }
+    bool isActive() const { return state() != ModeState::Idle; }
+
+signals:
+    void stateChanged(ModeState state);
+    // 第 loop 轮（从 0 开始）的第 step 步已发送，row 为对应的表格行
+    void progress(quint32 loop, int step, int row);
+    // 步骤迟到超过 MODELATEWARNMS
+    void stepLate(quint32 loop, int row, double lateMs);
+    // completed 为 false 表示被停止
+    void finished(bool completed, const ModeReport &report);
+
+private:
+    QThread *thread;             // 执行器线程
+    ModeRunner *runner;          // 工作对象，属于 thread
+};
+
+#endif // MODEEXECUTOR_H
@@ -0,0 +1,359 @@
+#include "serialworker.h"
+#include "protocol.h"
+
+#include <QElapsedTimer>
+#include <QSignalBlocker>
+
+#include <algorithm>
+
+SerialWorker::SerialWorker(QObject *parent)
+    : QObject(parent),
+    serialPort(new QSerialPort(this)),
+    heartbeatTimer(new QTimer(this)),
+    responseTimeoutTimer(new QTimer(this))
+{
+    // 子对象随工作对象一起移动到串口线程
+    connect(serialPort, &QSerialPort::readyRead, this, &SerialWorker::readSerialData);
+
+    heartbeatTimer->setInterval(HEARTBEATTIMESET);
+    connect(heartbeatTimer, &QTimer::timeout, this, &SerialWorker::sendHeartbeat);
+
+    responseTimeoutTimer->setSingleShot(true);  // 设置为单次定时器
+    connect(responseTimeoutTimer, &QTimer::timeout, this, &SerialWorker::onResponseTimeout);
+
+    parser.setFrameHandler([this](const uint8_t *frame, size_t len) { handleFrame(frame, len); });
+    parser.setErrorHandler([this](ParseError error, const uint8_t *frame, size_t len) {
+        handleParseError(error, frame, len);
+    });
+}
+
+SerialWorker::~SerialWorker()
+{
+    if (serialPort->isOpen()) {
+        serialPort->close();
+    }
+}
+
+void SerialWorker::setCapture(CaptureWriter *writer, quint8 portId)
+{
+    capture = writer;
+    capturePortId = portId;
+}
+
+void SerialWorker::log(const QString &text, const QColor &color)
+{
+    emit logMessage(text, color);
+}
+
+/*打开串口*/
+void SerialWorker::openPort(const QString &portName, const LineSettings &settings)
+{
+    // 初始化串口属性，设置 端口号、波特率、数据位、停止位、奇偶校验位数
+    serialPort->setPortName(portName);
+    // 自动识别时由 probeBaudRate 逐个设置候选速率
+    serialPort->setBaudRate(settings.baudRate > 0 ? settings.baudRate : BAUDRATE_CANDIDATES[0]);
+    serialPort->setDataBits(settings.dataBits);
+    serialPort->setStopBits(settings.stopBits);
+    serialPort->setParity(settings.parity);
+
+    if (!serialPort->open(QIODevice::ReadWrite)) {
+        emit portOpened(false);
+        return;
+    }
+
+    if (settings.baudRate <= 0) {
+        // 上次识别出的速率优先，其余候选从快到慢
+        QList<qint32> candidates;
+        if (settings.preferredBaudRate > 0) {
+            candidates.append(settings.preferredBaudRate);
+        }
+        for (qint32 rate : BAUDRATE_CANDIDATES) {
+            if (!candidates.contains(rate)) {
+                candidates.append(rate);
+            }
+        }
+
+        qint32 rate = probeBaudRate(candidates);
+        if (rate == 0) {
+            log("Error: 所有候选波特率均未收到心跳响应，无法识别波特率.", Qt::red);
+            serialPort->close();
+            emit portOpened(false);
+            return;
+        }
+        log(QString("波特率识别成功：%1").arg(rate), Qt::green);
+        emit baudRateDetected(rate);
+    }
+
+    parser.reset();  // 丢弃上次连接残留的数据
+    heartbeatTimer->start();
+    emit portOpened(true);
+}
+
+// 依次以候选波特率发送心跳帧，收到校验正确的心跳响应即锁定该速率，返回 0 表示均未响应
+// 识别期间屏蔽 readyRead，响应不进入正常的解析与调度流程
+qint32 SerialWorker::probeBaudRate(const QList<qint32> &candidates)
+{
+    QSignalBlocker blocker(serialPort);
+
+    uint8_t heartbeat[FRAMEMAXSIZE];
+    size_t heartbeatLength = createHeartbeatFrame().encode(heartbeat, sizeof(heartbeat));
+
+    bool matched = false;
+    FrameParser probeParser;
+    probeParser.setFrameHandler([&matched](const uint8_t *frame, size_t) {
+        if (frame[3] == HEARTBEAT) {
+            matched = true;
+        }
+    });
+
+    for (qint32 rate : candidates) {
+        if (!serialPort->setBaudRate(rate)) {
+            continue;
+        }
+        log(QString("尝试波特率 %1 ......").arg(rate));
+
+        serialPort->clear();
+        probeParser.reset();
+        matched = false;
+
+        serialPort->write(reinterpret_cast<const char*>(heartbeat), heartbeatLength);
+        if (capture) {
+            capture->append(CaptureDirection::TX, capturePortId, heartbeat, heartbeatLength);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        while (!matched && timer.elapsed() < BAUDPROBETIMEOUT) {
+            if (!serialPort->waitForReadyRead(static_cast<int>(BAUDPROBETIMEOUT - timer.elapsed()))) {
+                continue;
+            }
+            QByteArray receivedData = serialPort->readAll();
+            if (capture) {
+                capture->append(CaptureDirection::RX, capturePortId,
+                                reinterpret_cast<const uint8_t*>(receivedData.constData()), receivedData.size());
+            }
+            probeParser.feed(reinterpret_cast<const uint8_t*>(receivedData.constData()), receivedData.size());
+        }
+
+        if (matched) {
+            return rate;
+        }
+    }
+    return 0;
+}
+
+/*关闭串口*/
+// 关闭前先把队列中的指令（如复位）发完并等待响应，最多等待 CLOSEDRAINTIMEOUT
+void SerialWorker::closePort()
+{
+    // 停止心跳，不再产生新的指令
+    heartbeatTimer->stop();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (serialPort->isOpen() && (scheduler.inFlightCount() > 0 || scheduler.queuedCount() > 0)
+           && timer.elapsed() < CLOSEDRAINTIMEOUT) {
+        // 响应经 readyRead 进入解析与调度，超时重发由 pumpScheduler 处理
+        qint64 remaining = CLOSEDRAINTIMEOUT - timer.elapsed();
+        serialPort->waitForReadyRead(static_cast<int>(std::min<qint64>(RESPONSETIMEOUTTIMESET, remaining)));
+        pumpScheduler();
+    }
+
+    // 停止定时器
+    responseTimeoutTimer->stop();
+
+    scheduler.clear();
+
+    if (serialPort->isOpen()) {
+        serialPort->close();
+    }
+    parser.reset();
+}
+
+void SerialWorker::sendHeartbeat()
+{
+    // 心跳帧在编译期生成，直接引用静态数据
+    QByteArray frame = QByteArray::fromRawData(reinterpret_cast<const char*>(HEARTBEAT_FRAME.data()),
+                                               HEARTBEAT_FRAME.size());
+    enqueueCommand(frame, "发送心跳帧", Qt::black, CommandPriority::Background);
+}
+
+// 响应等待超时处理槽函数
+void SerialWorker::onResponseTimeout() {
+    pumpScheduler();
+}
+
+void SerialWorker::enqueueCommand(const QByteArray &data, const QString &str_log, const QColor &color,
+                                  CommandPriority priority, quint32 group)
+{
+    // 将指令加入队列，窗口未满时立即发送
+    scheduler.enqueue(std::vector<uint8_t>(data.begin(), data.end()), str_log.toStdString(), color.rgba(), priority,
+                      group);
+    pumpScheduler();
+}
+
+void SerialWorker::cancelModeSteps()
+{
+    size_t count = scheduler.cancelGroup(MODESTEPGROUP);
+    if (count > 0) {
+        log(QString("模式已停止，取消 %1 条尚未发送的模式步骤.").arg(count), Qt::darkYellow);
+    }
+    pumpScheduler();
+}
+
+void SerialWorker::setWindowSize(int size)
+{
+    scheduler.setWindowSize(size > 0 ? size : 1);
+    pumpScheduler();
+}
+
+// 处理超时与发送窗口
+void SerialWorker::pumpScheduler()
+{
+    scheduler.poll(CommandScheduler::Clock::now(), schedulerEvents);
+    handleSchedulerEvents();
+}
+
+// 执行调度器产生的事件，并把超时定时器对准最近的截止时刻
+void SerialWorker::handleSchedulerEvents()
+{
+    for (const SchedulerEvent &event : schedulerEvents) {
+        const ScheduledCommand &command = event.command;
+        QString str_log = QString::fromStdString(command.label);
+
+        switch (event.type) {
+            case SchedulerEvent::Transmit: {
+                // 显示发送的帧内容
+                log(QString("%1 开始......").arg(str_log), QColor::fromRgba(command.tag));
+                QString logMessage = "Sending Frame: ";
+                for (auto byte : command.frame) {
+                    logMessage += QString("%1 ").arg(byte, 2, 16, QChar('0')).toUpper();
+                }
+                log(logMessage);
+                writeFrame(command);
+                break;
+            }
+            case SchedulerEvent::Retransmit:
+                log(QString("Error: %1 response timeout.").arg(str_log), Qt::red);
+                if (command.expect.command == HEARTBEAT) {
+                    log("Error: 等待心跳超时，禁止操作面板，直至心跳恢复！请检查模组连接是否出现异常。", Qt::red);
+                    emit heartbeatTimeout();
+                }
+                emit responseTimeout();
+                log(QString("Warning: 第%1次发送未收到响应，重试...").arg(command.attempts - 1), Qt::red);
+                writeFrame(command);
+                break;
+            case SchedulerEvent::Completed:
+                log(QString("%1 成功！").arg(str_log), Qt::green);
+                log("---------------", Qt::lightGray);
+                break;
+            case SchedulerEvent::Failed:
+                log(QString("Error: %1 response timeout.").arg(str_log), Qt::red);
+                emit responseTimeout();
+                log("Error: 三次发送均未收到响应，跳过此指令.", Qt::red);
+                log(QString("%1 超时！").arg(str_log), Qt::red);
+                break;
+            case SchedulerEvent::Cancelled:
+                if (command.group == MODESTEPGROUP) {
+                    log(QString("%1 已取消发送.").arg(str_log), Qt::darkYellow);
+                } else {
+                    log(QString("%1 已被新指令取代，取消发送.").arg(str_log), Qt::darkYellow);
+                }
+                break;
+        }
+
+        // 设备控制指令的结果交给界面线程更新设备状态模型
+        bool finished = event.type == SchedulerEvent::Completed || event.type == SchedulerEvent::Failed
+                        || event.type == SchedulerEvent::Cancelled;
+        if (finished && command.frame.size() > 3 && command.frame[3] == DEVICE_CONTROL) {
+            emit commandFinished(QByteArray(reinterpret_cast<const char*>(command.frame.data()), command.frame.size()),
+                                 event.type == SchedulerEvent::Completed);
+        }
+    }
+    schedulerEvents.clear();
+
+    CommandScheduler::Clock::time_point deadline;
+    if (scheduler.nextDeadline(deadline)) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - CommandScheduler::Clock::now());
+        responseTimeoutTimer->start(static_cast<int>(std::max<qint64>(0, remaining.count() + 1)));
+    } else {
+        responseTimeoutTimer->stop();
+    }
+}
+
+void SerialWorker::writeFrame(const ScheduledCommand &command)
+{
+    if (serialPort->isOpen() && serialPort->isWritable()) {
+        serialPort->write(reinterpret_cast<const char*>(command.frame.data()), command.frame.size());
+        if (capture) {
+            capture->append(CaptureDirection::TX, capturePortId, command.frame.data(), command.frame.size());
+        }
+        log("发送数据完成");
+    } else {
+        // 写入失败也按未收到响应处理，由超时驱动重试
+        log("Error: Serial port not open or writable.", Qt::red);
+    }
+}
+
+// 串口数据读取函数
+void SerialWorker::readSerialData()
+{
+    QByteArray receivedData = serialPort->readAll();  // 读取数据
+    if (capture) {
+        capture->append(CaptureDirection::RX, capturePortId,
+                        reinterpret_cast<const uint8_t*>(receivedData.constData()), receivedData.size());
+    }
+
+    // 追加到解析器的环形缓冲区，不完整的帧保留到下次 readyRead
+    size_t dropped = parser.feed(reinterpret_cast<const uint8_t*>(receivedData.constData()), receivedData.size());
+    if (dropped > 0) {
+        log(QString("Warning: 接收缓冲区溢出，丢弃 %1 字节.").arg(dropped), Qt::red);
+    }
+}
+
+static QString formatFrame(const QString &prefix, const uint8_t *frame, size_t len)
+{
+    QString logMessage = prefix;
+    for (size_t i = 0; i < len; ++i) {
+        logMessage += QString("%1 ").arg(frame[i], 2, 16, QChar('0')).toUpper();  // 将字节格式化为两位十六进制
+    }
+    return logMessage;
+}
+
+// 校验通过的帧：交给界面线程处理，并与在途请求配对
+void SerialWorker::handleFrame(const uint8_t *frame, size_t len)
+{
+    // 输出接收到的帧内容
+    log(formatFrame("Received Frame: ", frame, len), Qt::blue);
+
+    uint8_t command = frame[3];
+    const uint8_t *data = frame + 6;
+    size_t dataLength = len - 7;
+    emit frameReceived(command, QByteArray(reinterpret_cast<const char*>(data), dataLength));
+
+    // 按 命令字 + DP ID 与在途请求配对
+    if (!scheduler.onResponse(command, data, dataLength, CommandScheduler::Clock::now(), schedulerEvents)) {
+        log("Warning: 收到未匹配任何请求的响应帧.", Qt::darkYellow);
+    }
+    handleSchedulerEvents();
+}
+
+void SerialWorker::handleParseError(ParseError error, const uint8_t *frame, size_t len)
+{
+    switch (error) {
+        case ParseError::NoHeader:
+            log("Error: Incomplete or invalid frame, unable to find frame header.", Qt::red);
+            break;
+        case ParseError::InvalidLength:
+            log("Error: Invalid frame length, resynchronizing.", Qt::red);
+            break;
+        case ParseError::ChecksumMismatch:
+            log(formatFrame("Received Frame: ", frame, len), Qt::blue);
+            log("校验和错误！！", Qt::red);
+            log("计算值：");
+            log(QString::number(FrameParser::checksum(frame, len - 1)));
+            log("原有值：");
+            log(QString::number(frame[len - 1]));
+            break;
+    }
+}
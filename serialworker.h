@@ -0,0 +1,100 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QtSerialPort/QSerialPort>
+#include <QTimer>
+#include <QByteArray>
+#include <QString>
+#include <QColor>
+#include <QList>
+#include <QMetaType>
+
+#include "frameparser.h"
+#include "commandscheduler.h"
+#include "capture.h"
+
+#define BAUDPROBETIMEOUT        200      // 自动识别波特率时每个候选速率等待心跳响应的时间（毫秒）
+#define MODESTEPGROUP           1        // 模式步骤在指令调度器中的分组，停止模式时整体取消
+#define CLOSEDRAINTIMEOUT       (RESPONSETIMEOUTTIMESET * SENDMAXATTEMPTS)   // 关闭串口前等待队列中指令结束的最长时间（毫秒）
+
+// 自动识别时依次尝试的波特率，从快到慢
+constexpr qint32 BAUDRATE_CANDIDATES[] = {115200, 57600, 38400, 19200, 9600};
+
+// 串口线路参数
+struct LineSettings {
+    qint32 baudRate = QSerialPort::Baud9600;    // 0 表示自动识别
+    qint32 preferredBaudRate = 0;               // 自动识别时最先尝试的速率（上次识别结果），0 表示无
+    QSerialPort::DataBits dataBits = QSerialPort::Data8;
+    QSerialPort::Parity parity = QSerialPort::NoParity;
+    QSerialPort::StopBits stopBits = QSerialPort::OneStop;
+};
+Q_DECLARE_METATYPE(LineSettings)
+Q_DECLARE_METATYPE(CommandPriority)
+
+// 串口工作对象
+// 串口、定时器、指令队列和帧解析全部运行在独立的串口线程中，
+// 与界面之间只通过排队信号通信，界面阻塞不影响收发
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialWorker(QObject *parent = nullptr);
+    ~SerialWorker();
+
+    // 设置抓包输出，收发的原始字节按 portId 记录（移动到串口线程前调用）
+    void setCapture(CaptureWriter *writer, quint8 portId);
+
+public slots:
+    void openPort(const QString &portName, const LineSettings &settings);
+    void closePort();
+
+    // 将指令加入发送队列，priority 决定发送通道，group 为调度器分组（见 CommandScheduler）
+    void enqueueCommand(const QByteArray &data, const QString &str_log, const QColor &color, CommandPriority priority,
+                        quint32 group = 0);
+    // 取消尚未发送的模式步骤，已发出的步骤照常等待响应
+    void cancelModeSteps();
+
+    // 设置发送窗口：同时等待响应的指令数
+    void setWindowSize(int size);
+
+signals:
+    void logMessage(const QString &text, const QColor &color);
+    void portOpened(bool ok);
+    void baudRateDetected(qint32 baudRate);   // 自动识别出的波特率
+    void frameReceived(quint8 command, const QByteArray &data);   // 校验通过的下位机响应帧
+    void responseTimeout();
+    void heartbeatTimeout();
+    // 指令结束：completed 为 false 表示超时或被取代
+    void commandFinished(const QByteArray &frame, bool completed);
+
+private slots:
+    void readSerialData();
+    void sendHeartbeat();
+    void onResponseTimeout();
+
+private:
+    void log(const QString &text, const QColor &color = Qt::black);
+    qint32 probeBaudRate(const QList<qint32> &candidates);
+    void pumpScheduler();
+    void handleSchedulerEvents();
+    void writeFrame(const ScheduledCommand &command);
+    void handleFrame(const uint8_t *frame, size_t len);
+    void handleParseError(ParseError error, const uint8_t *frame, size_t len);
+
+    QSerialPort *serialPort;
+    QTimer *heartbeatTimer;        // 心跳定时器
+    QTimer *responseTimeoutTimer;  // 响应超时定时器
+    FrameParser parser;            // 帧解析，内部环形缓冲区跨多次读取保留不完整的帧
+
+    CaptureWriter *capture = nullptr;  // 抓包输出，可为空
+    quint8 capturePortId = 0;
+
+    // 窗口化发送：每条在途指令独立经历 AwaitingResponse -> Retry/Timeout，
+    // 由 readyRead 和超时定时器驱动，超时定时器始终对准最近的截止时刻
+    CommandScheduler scheduler;
+    std::vector<SchedulerEvent> schedulerEvents;
+};
+
+#endif // SERIALWORKER_H
@@ -0,0 +1,10 @@
+# 协议核心单元测试（命令行，不依赖 Qt），make check 时运行
+TEMPLATE = app
+TARGET = coretest
+CONFIG += console c++17 testcase
+CONFIG -= qt app_bundle
+
+include(../../core/core.pri)
+
+SOURCES += \
+    main.cpp
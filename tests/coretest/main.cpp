@@ -0,0 +1,236 @@
+// 协议核心单元测试
+//
+// 用法: coretest [--filter 子串]
+//
+// 每个用例输出一行 PASS/FAIL，有失败的用例时返回 1
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+#include "commandscheduler.h"
+#include "dpcodec.h"
+#include "frameparser.h"
+#include "modeprogram.h"
+#include "modetimeline.h"
+#include "protocol.h"
+
+static int failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            std::printf("  %s:%d: CHECK(%s) 失败\n", __FILE__, __LINE__, #expr); \
+            ++failures; \
+        } \
+    } while (0)
+
+template <size_t N>
+static std::vector<uint8_t> bytes(const std::array<uint8_t, N> &frame)
+{
+    return std::vector<uint8_t>(frame.begin(), frame.end());
+}
+
+static size_t countEvents(const std::vector<SchedulerEvent> &events, SchedulerEvent::Type type, const char *label)
+{
+    size_t count = 0;
+    for (const auto &event : events) {
+        if (event.type == type && event.command.label == label) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// 下位机对设备控制帧的应答：回显同一 DP 的功能数据
+template <size_t N>
+static bool feedReply(CommandScheduler &scheduler, const std::array<uint8_t, N> &request,
+                      CommandScheduler::Clock::time_point now, std::vector<SchedulerEvent> &events)
+{
+    return scheduler.onResponse(MCU_RESPONSE, request.data() + 6, request.size() - FRAMEOVERHEAD, now, events);
+}
+
+// STOP 取代在途的 UP 之后，UP 的迟到应答不能当作 STOP 的确认
+static void testStopIgnoresSupersededReply()
+{
+    using Clock = CommandScheduler::Clock;
+    CommandScheduler scheduler;
+    std::vector<SchedulerEvent> events;
+    Clock::time_point now = Clock::now();
+
+    scheduler.enqueue(bytes(POSITION_UP_FRAME), "UP", 0, CommandPriority::Interactive);
+    scheduler.poll(now, events);
+    CHECK(countEvents(events, SchedulerEvent::Transmit, "UP") == 1);
+
+    events.clear();
+    scheduler.enqueue(bytes(POSITION_STOP_FRAME), "STOP", 0, CommandPriority::Safety);
+    scheduler.poll(now, events);
+    CHECK(countEvents(events, SchedulerEvent::Cancelled, "UP") == 1);
+    CHECK(countEvents(events, SchedulerEvent::Transmit, "STOP") == 1);
+
+    // UP 的应答被墓碑吸收，STOP 仍在途
+    events.clear();
+    CHECK(feedReply(scheduler, POSITION_UP_FRAME, now, events));
+    CHECK(countEvents(events, SchedulerEvent::Completed, "STOP") == 0);
+    CHECK(scheduler.inFlightCount() == 1);
+
+    // STOP 丢失：超时后重发
+    events.clear();
+    now += std::chrono::milliseconds(RESPONSETIMEOUTTIMESET + 1);
+    scheduler.poll(now, events);
+    CHECK(countEvents(events, SchedulerEvent::Retransmit, "STOP") == 1);
+
+    // 重发的 STOP 收到应答后完成
+    events.clear();
+    CHECK(feedReply(scheduler, POSITION_STOP_FRAME, now, events));
+    CHECK(countEvents(events, SchedulerEvent::Completed, "STOP") == 1);
+    CHECK(scheduler.inFlightCount() == 0);
+}
+
+// 文件头中的 headerSize 小于固定文件头或超过文件长度时拒绝打开
+static void testCaptureRejectsBadHeaderSize()
+{
+    const char *path = "coretest_capture.tmp";
+    {
+        CaptureWriter writer;
+        CHECK(writer.open(path));
+        writer.append(CaptureDirection::TX, 0, HEARTBEAT_FRAME.data(), HEARTBEAT_FRAME.size());
+    }
+
+    CaptureReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.recordCount() == 1);
+    reader.close();
+
+    for (uint16_t headerSize : {uint16_t(0), uint16_t(CAPTUREFILEHEADERSIZE - 1), uint16_t(0xFFFF)}) {
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(10);
+            char bytes[2] = {static_cast<char>(headerSize & 0xFF), static_cast<char>(headerSize >> 8)};
+            file.write(bytes, sizeof(bytes));
+        }
+        CHECK(!reader.open(path));
+        CHECK(reader.errorString() == "invalid capture header size");
+    }
+    std::remove(path);
+}
+
+// 校验和正确但数据长度超过 FRAMEMAXDATALENGTH 的帧按长度错误统计，不交给回调
+static void testParserRejectsOversizedFrame()
+{
+    std::vector<uint8_t> oversized = {0x55, 0xAA, VERSION, MCU_RESPONSE, 0x00, FRAMEMAXDATALENGTH + 1};
+    oversized.resize(6 + FRAMEMAXDATALENGTH + 1, 0x01);
+    oversized.push_back(FrameParser::checksum(oversized.data(), oversized.size()));
+    std::vector<uint8_t> stream = oversized;
+    stream.insert(stream.end(), HEARTBEAT_FRAME.begin(), HEARTBEAT_FRAME.end());
+
+    FrameParser parser;
+    std::vector<size_t> lengths;
+    parser.setFrameHandler([&lengths](const uint8_t *, size_t len) { lengths.push_back(len); });
+    parser.feed(stream.data(), stream.size());
+
+    CHECK(parser.stats().lengthErrors == 1);
+    CHECK(parser.stats().frames == 1);
+    CHECK(lengths == std::vector<size_t>({HEARTBEAT_FRAME.size()}));
+}
+
+static ModeProgram compileRows(const std::vector<ModeRow> &rows)
+{
+    ModeBase base = {static_cast<uint8_t>(SwitchValue::SWITCH_ON), 99, 0x11};
+    ModeProgram program;
+    size_t errorRow = 0;
+    std::string error;
+    CHECK(ModeProgram::compile(base, rows, 1, program, errorRow, error));
+    return program;
+}
+
+// 按 tick 的方式发送到期的步骤，返回发送的表格行
+static std::vector<uint16_t> sendDue(ModeTimeline &timeline, const ModeProgram &program,
+                                     ModeTimeline::Clock::time_point now)
+{
+    std::vector<uint16_t> rows;
+    while (!timeline.done() && timeline.deadline() <= now) {
+        timeline.skipSuperseded(now);
+        rows.push_back(program[timeline.step()].row);
+        timeline.advance(now);
+    }
+    return rows;
+}
+
+// 零延时行与下一行计划时刻相同，即使稍有迟到也要发送，不计入跳过
+static void testTimelineSendsZeroDelayRow()
+{
+    ModeProgram program = compileRows({{0, 1, 0, 0}, {0, 2, 0, 100}, {0, 3, 0, 100}});
+    ModeTimeline timeline(program);
+    ModeTimeline::Clock::time_point origin = ModeTimeline::Clock::now();
+    timeline.start(origin);
+
+    std::vector<uint16_t> rows = sendDue(timeline, program, origin + std::chrono::milliseconds(1));
+    CHECK(rows == std::vector<uint16_t>({0, 1}));
+    rows = sendDue(timeline, program, origin + std::chrono::milliseconds(100));
+    CHECK(rows == std::vector<uint16_t>({2}));
+    CHECK(timeline.done());
+    CHECK(timeline.lateness().skipped == 0);
+    CHECK(timeline.lateness().steps == 3);
+}
+
+// 落后超过一步时只发送最后一个到期的步骤
+static void testTimelineSkipsSupersededSteps()
+{
+    ModeProgram program = compileRows({{0, 1, 0, 10}, {0, 2, 0, 10}, {0, 3, 0, 10}, {0, 4, 0, 10}});
+    ModeTimeline timeline(program);
+    ModeTimeline::Clock::time_point origin = ModeTimeline::Clock::now();
+    timeline.start(origin);
+
+    std::vector<uint16_t> rows = sendDue(timeline, program, origin + std::chrono::milliseconds(25));
+    CHECK(rows == std::vector<uint16_t>({2}));
+    CHECK(timeline.lateness().skipped == 2);
+    rows = sendDue(timeline, program, origin + std::chrono::milliseconds(30));
+    CHECK(rows == std::vector<uint16_t>({3}));
+    CHECK(timeline.lateness().skipped == 2);
+}
+
+struct TestCase {
+    const char *name;
+    void (*run)();
+};
+
+static const TestCase TESTS[] = {
+    {"scheduler/stop_ignores_superseded_reply", testStopIgnoresSupersededReply},
+    {"capture/rejects_bad_header_size", testCaptureRejectsBadHeaderSize},
+    {"parser/rejects_oversized_frame", testParserRejectsOversizedFrame},
+    {"timeline/sends_zero_delay_row", testTimelineSendsZeroDelayRow},
+    {"timeline/skips_superseded_steps", testTimelineSkipsSupersededSteps},
+};
+
+int main(int argc, char *argv[])
+{
+    const char *filter = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::fprintf(stderr, "用法: %s [--filter 子串]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int failedCases = 0;
+    for (const TestCase &test : TESTS) {
+        if (filter && !std::strstr(test.name, filter)) {
+            continue;
+        }
+        int before = failures;
+        test.run();
+        bool passed = failures == before;
+        std::printf("%s %s\n", passed ? "PASS" : "FAIL", test.name);
+        if (!passed) {
+            ++failedCases;
+        }
+    }
+    return failedCases == 0 ? 0 : 1;
+}
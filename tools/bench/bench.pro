@@ -0,0 +1,10 @@
+# 协议核心微基准测试（命令行，不依赖 Qt）
+TEMPLATE = app
+TARGET = bench
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../../core/core.pri)
+
+SOURCES += \
+    main.cpp
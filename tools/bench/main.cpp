@@ -0,0 +1,336 @@
+// 协议核心微基准测试
+//
+// 用法: bench [--filter 子串] [--min-time 秒]
+//
+// 帧头查找与校验和内核对 CPU 支持的每种实现（scalar/sse2/avx2）分别测试，
+// 解析器用例使用运行时选择的实现
+//
+// 每个用例输出一行 JSON，便于不同版本之间对比：
+//   {"name":"...","iterations":N,"ns_per_op":x,"allocs_per_op":y,"bytes_per_op":b,"bytes_per_sec":z}
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bytescan.h"
+#include "dpcodec.h"
+#include "frameparser.h"
+#include "modeprogram.h"
+#include "protocol.h"
+
+// 统计堆分配次数
+static std::atomic<uint64_t> allocationCount(0);
+
+void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// 防止编译器优化掉被测结果
+template <typename T>
+static void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+struct BenchOptions {
+    std::string filter;
+    double minTime = 0.2;
+};
+
+// 运行一个用例：先倍增迭代次数直到耗时超过 minTime，再按最后一轮计算结果
+template <typename F>
+static void runBench(const BenchOptions &options, const std::string &name, size_t bytesPerOp, F body)
+{
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    uint64_t iterations = 1;
+    for (;;) {
+        uint64_t allocsBefore = allocationCount.load(std::memory_order_relaxed);
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        uint64_t allocs = allocationCount.load(std::memory_order_relaxed) - allocsBefore;
+
+        if (seconds >= options.minTime || iterations >= (1ull << 40)) {
+            double nsPerOp = seconds * 1e9 / iterations;
+            double bytesPerSec = seconds > 0 ? static_cast<double>(bytesPerOp) * iterations / seconds : 0;
+            std::printf("{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.2f,\"allocs_per_op\":%.2f,"
+                        "\"bytes_per_op\":%zu,\"bytes_per_sec\":%.0f}\n",
+                        name.c_str(), static_cast<unsigned long long>(iterations), nsPerOp,
+                        static_cast<double>(allocs) / iterations, bytesPerOp, bytesPerSec);
+            std::fflush(stdout);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+// 固定种子的伪随机数，保证每次运行输入相同
+static uint32_t nextRandom(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// 典型的下位机响应：心跳、ALL_STATUS、单个 DP
+static std::vector<std::vector<uint8_t>> sampleResponses()
+{
+    return {
+        {0x55, 0xAA, 0x03, 0x00, 0x00, 0x01, 0x01, 0x04},
+        {0x55, 0xAA, 0x03, 0x07, 0x00, 0x0C, 0x69, 0x02, 0x00, 0x08,
+         0x01, 0x01, 0x11, 0x22, 0x10, 0x33, 0x02, 0x01, 0x03},
+        ProtocolFrame(MCU_RESPONSE, {0x66, 0x02, 0x00, 0x02, 0x00, 0x63}).serialize(),
+        ProtocolFrame(MCU_RESPONSE, {0x67, 0x04, 0x00, 0x01, 0x01}).serialize(),
+    };
+}
+
+// 干净的字节流
+static std::vector<uint8_t> cleanStream(size_t size)
+{
+    std::vector<std::vector<uint8_t>> frames = sampleResponses();
+    std::vector<uint8_t> stream;
+    for (size_t i = 0; stream.size() < size; ++i) {
+        const std::vector<uint8_t> &frame = frames[i % frames.size()];
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    return stream;
+}
+
+// 带噪声的字节流：帧间插入随机字节（含伪帧头），部分帧校验和损坏
+static std::vector<uint8_t> noisyStream(size_t size)
+{
+    std::vector<std::vector<uint8_t>> frames = sampleResponses();
+    std::vector<uint8_t> stream;
+    uint32_t seed = 12345;
+    for (size_t i = 0; stream.size() < size; ++i) {
+        size_t noise = nextRandom(seed) % 8;
+        for (size_t n = 0; n < noise; ++n) {
+            stream.push_back(nextRandom(seed) % 4 == 0 ? 0x55 : static_cast<uint8_t>(nextRandom(seed)));
+        }
+        std::vector<uint8_t> frame = frames[i % frames.size()];
+        if (nextRandom(seed) % 16 == 0) {
+            frame.back() ^= 0x5A;
+        }
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    return stream;
+}
+
+// 把字节流切分为串口读取的块大小
+static std::vector<size_t> chunkSizes(size_t total, size_t minChunk, size_t maxChunk, uint32_t seed)
+{
+    std::vector<size_t> chunks;
+    size_t used = 0;
+    while (used < total) {
+        size_t chunk = minChunk + nextRandom(seed) % (maxChunk - minChunk + 1);
+        chunk = std::min(chunk, total - used);
+        chunks.push_back(chunk);
+        used += chunk;
+    }
+    return chunks;
+}
+
+static void benchParser(const BenchOptions &options, const std::string &name,
+                        const std::vector<uint8_t> &stream, const std::vector<size_t> &chunks)
+{
+    FrameParser parser;
+    uint64_t frames = 0;
+    parser.setFrameHandler([&frames](const uint8_t *, size_t) { ++frames; });
+    parser.setErrorHandler([](ParseError, const uint8_t *, size_t) {});
+
+    runBench(options, name, stream.size(), [&]() {
+        const uint8_t *p = stream.data();
+        for (size_t chunk : chunks) {
+            parser.feed(p, chunk);
+            p += chunk;
+        }
+        parser.reset();
+        doNotOptimize(frames);
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.minTime = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: bench [--filter SUBSTRING] [--min-time SECONDS]\n");
+            return 2;
+        }
+    }
+
+    // ProtocolFrame
+    ProtocolFrame allStatus = createDeviceControlFrame(DPType::ALL_STATUS, {0x01, 0x00, 0x00, 0x63, 0x00, 0x01, 0x00, 0x00});
+    std::vector<uint8_t> allStatusBytes = allStatus.serialize();
+
+    runBench(options, "ProtocolFrame::serialize/all_status", allStatusBytes.size(), [&]() {
+        std::vector<uint8_t> bytes = allStatus.serialize();
+        doNotOptimize(bytes);
+    });
+    runBench(options, "ProtocolFrame::deserialize/all_status", allStatusBytes.size(), [&]() {
+        ProtocolFrame frame = ProtocolFrame::deserialize(allStatusBytes);
+        doNotOptimize(frame);
+    });
+    runBench(options, "ProtocolFrame::encode/all_status", allStatusBytes.size(), [&]() {
+        uint8_t bytes[FRAMEMAXSIZE];
+        size_t size = allStatus.encode(bytes, sizeof(bytes));
+        doNotOptimize(bytes);
+        doNotOptimize(size);
+    });
+    runBench(options, "ProtocolFrame::decode/all_status", allStatusBytes.size(), [&]() {
+        ProtocolFrame frame;
+        bool ok = ProtocolFrame::decode(allStatusBytes.data(), allStatusBytes.size(), frame);
+        doNotOptimize(frame);
+        doNotOptimize(ok);
+    });
+    runBench(options, "ProtocolFrame::calculateChecksum/all_status", allStatusBytes.size() - 1, [&]() {
+        uint8_t sum = allStatus.calculateChecksum(allStatusBytes);
+        doNotOptimize(sum);
+    });
+    runBench(options, "createHeartbeatFrame", 7, [&]() {
+        ProtocolFrame frame = createHeartbeatFrame();
+        doNotOptimize(frame);
+    });
+    runBench(options, "HEARTBEAT_FRAME/memcpy", HEARTBEAT_FRAME.size(), [&]() {
+        uint8_t bytes[FRAMEMAXSIZE];
+        std::memcpy(bytes, HEARTBEAT_FRAME.data(), HEARTBEAT_FRAME.size());
+        doNotOptimize(bytes);
+    });
+    runBench(options, "createQueryStatusFrame", 7, [&]() {
+        ProtocolFrame frame = createQueryStatusFrame();
+        doNotOptimize(frame);
+    });
+
+    // 每个 DPType 的设备控制帧
+    struct DPCase {
+        const char *name;
+        DPType dp;
+        std::vector<uint8_t> value;
+    };
+    const DPCase dpCases[] = {
+        {"off_on", DPType::OFF_ON, {0x01}},
+        {"access_select", DPType::ACCESS_SELECT, {0x02}},
+        {"maxchannel", DPType::MAXCHANNEL, {0x00, 0x63}},
+        {"channel", DPType::CHANNEL, {0x00, 0x10}},
+        {"position_control", DPType::POSITION_CONTROL, {0x01}},
+        {"a_f_select", DPType::A_F_SELECT, {0x00}},
+        {"all_status", DPType::ALL_STATUS, {0x01, 0x00, 0x00, 0x63, 0x00, 0x01, 0x00, 0x00}},
+    };
+    for (const DPCase &c : dpCases) {
+        runBench(options, std::string("createDeviceControlFrame/") + c.name, 11 + c.value.size(), [&]() {
+            ProtocolFrame frame = createDeviceControlFrame(c.dp, c.value.data(), c.value.size());
+            doNotOptimize(frame);
+        });
+    }
+
+    // 模板化 DP 编码
+    runBench(options, "DP::encode/channel", DP<DPType::CHANNEL>::Frame().size(), [&]() {
+        DP<DPType::CHANNEL>::Frame frame = DP<DPType::CHANNEL>::encode(static_cast<uint16_t>(0x10));
+        doNotOptimize(frame);
+    });
+    AllStatus status = {};
+    status.maxChannel.set(0x63);
+    status.channel.set(0x10);
+    runBench(options, "DP::encode/all_status", DP<DPType::ALL_STATUS>::Frame().size(), [&]() {
+        DP<DPType::ALL_STATUS>::Frame frame = DP<DPType::ALL_STATUS>::encode(status);
+        doNotOptimize(frame);
+    });
+
+    // 模式步骤：每步重新编码与选择预编码帧
+    ModeBase modeBase = {0x01, 0x63, 0x01};
+    std::vector<ModeRow> modeRows = {{0x01, 0x10, 0x00, 1000}, {0x02, 0x20, 0x02, 1000}};
+    ModeProgram program;
+    size_t errorRow = 0;
+    std::string error;
+    ModeProgram::compile(modeBase, modeRows, 1, program, errorRow, error);
+    DeviceStateModel model;
+    model.onSent(program[0].allStatusFrame.data(), program[0].allStatusFrame.size());
+    runBench(options, "DeviceStateModel::diff/mode_step", program[1].allStatusFrame.size(), [&]() {
+        std::vector<std::vector<uint8_t>> frames;
+        size_t count = model.diff(program[1].target, frames);
+        doNotOptimize(frames);
+        doNotOptimize(count);
+    });
+    runBench(options, "ModeProgram::selectFrames/mode_step", program[1].allStatusFrame.size(), [&]() {
+        ModeFrameRef frames[DEVICESTATEFIELDCOUNT];
+        size_t count = ModeProgram::selectFrames(program[1], model, frames);
+        doNotOptimize(frames);
+        doNotOptimize(count);
+    });
+
+    // 帧头查找与帧提取
+    const size_t streamSize = 64 * 1024;
+    std::vector<uint8_t> clean = cleanStream(streamSize);
+    std::vector<uint8_t> noisy = noisyStream(streamSize);
+
+    // 扫描内核：无帧头的随机数据（最坏情况）与整段校验和
+    std::vector<uint8_t> garbage(streamSize);
+    uint32_t seed = 99;
+    for (uint8_t &byte : garbage) {
+        byte = static_cast<uint8_t>(nextRandom(seed));
+        if (byte == 0x55) {
+            byte = 0x54;
+        }
+    }
+    SimdLevel defaultLevel = simdLevel();
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (!setSimdLevel(level)) {
+            continue;
+        }
+        std::string suffix = std::string("/") + simdLevelName(level);
+        runBench(options, "findSyncWord/no_header" + suffix, garbage.size(), [&]() {
+            size_t pos = findSyncWord(garbage.data(), garbage.size());
+            doNotOptimize(pos);
+        });
+        runBench(options, "checksum8/64k" + suffix, garbage.size(), [&]() {
+            uint8_t sum = checksum8(garbage.data(), garbage.size());
+            doNotOptimize(sum);
+        });
+        runBench(options, "checksum8/all_status" + suffix, allStatusBytes.size() - 1, [&]() {
+            uint8_t sum = checksum8(allStatusBytes.data(), allStatusBytes.size() - 1);
+            doNotOptimize(sum);
+        });
+    }
+    setSimdLevel(defaultLevel);
+    benchParser(options, "FrameParser::feed/clean", clean, chunkSizes(clean.size(), 256, 256, 1));
+    benchParser(options, "FrameParser::feed/noisy", noisy, chunkSizes(noisy.size(), 256, 256, 2));
+    benchParser(options, "FrameParser::feed/fragmented", clean, chunkSizes(clean.size(), 1, 16, 3));
+    benchParser(options, "FrameParser::feed/noisy_fragmented", noisy, chunkSizes(noisy.size(), 1, 16, 4));
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+# 多串口压力工具（命令行，仅 Linux，不依赖 Qt）
+TEMPLATE = app
+TARGET = fleet
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../../core/core.pri)
+
+LIBS += -lpthread
+
+SOURCES += \
+    main.cpp
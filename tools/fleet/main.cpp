@@ -0,0 +1,193 @@
+// 多串口压力工具：用一个 epoll 反应器线程同时驱动大量下位机
+//
+// 用法: fleet [--baud N] [--query MS] [--duration S] [--window N] [--no-heartbeat] PORT...
+//
+//   --baud          串口波特率（默认 9600）
+//   --query         每个端口发送状态查询的间隔（毫秒），0 表示只发送心跳（默认 1000）
+//   --duration      运行时长（秒），0 表示直到 Ctrl+C（默认 0）
+//   --window        每个端口同时在途的指令数
+//   --no-heartbeat  不发送心跳
+//
+// 每秒输出一行统计，退出时输出 key=value 格式的汇总
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "protocol.h"
+#include "serialreactor.h"
+
+using Clock = std::chrono::steady_clock;
+
+static volatile std::sig_atomic_t running = 1;
+
+static void onSignal(int)
+{
+    running = 0;
+}
+
+struct FleetCounters {
+    std::atomic<uint64_t> transmitted{0};
+    std::atomic<uint64_t> retransmitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> parseErrors{0};
+    std::atomic<uint64_t> portErrors{0};
+};
+
+static double cpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+           + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: fleet [--baud N] [--query MS] [--duration S] [--window N] [--no-heartbeat] PORT...\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int baud = 9600;
+    int queryMs = 1000;
+    double duration = 0;
+    int window = 0;
+    bool heartbeat = true;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--baud") == 0 && hasValue) {
+            baud = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--query") == 0 && hasValue) {
+            queryMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--duration") == 0 && hasValue) {
+            duration = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--window") == 0 && hasValue) {
+            window = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--no-heartbeat") == 0) {
+            heartbeat = false;
+        } else if (arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        usage();
+        return 2;
+    }
+
+    FleetCounters counters;
+    SerialReactor reactor;
+    ReactorHandlers handlers;
+    handlers.scheduler = [&counters](int, const SchedulerEvent &event) {
+        switch (event.type) {
+            case SchedulerEvent::Transmit:   counters.transmitted++;   break;
+            case SchedulerEvent::Retransmit: counters.retransmitted++; break;
+            case SchedulerEvent::Completed:  counters.completed++;     break;
+            case SchedulerEvent::Failed:     counters.failed++;        break;
+            case SchedulerEvent::Cancelled:  break;
+        }
+    };
+    handlers.parseError = [&counters](int, ParseError) { counters.parseErrors++; };
+    handlers.portError = [&counters, &paths](int port, int error) {
+        counters.portErrors++;
+        std::fprintf(stderr, "fleet: %s: %s\n", paths[port].c_str(), std::strerror(error));
+    };
+    reactor.setHandlers(handlers);
+    reactor.setHeartbeatInterval(heartbeat ? HEARTBEATTIMESET : 0);
+    if (window > 0) {
+        reactor.setWindowSize(window);
+    }
+
+    // 端口编号按打开顺序分配，与 paths 下标一致
+    std::vector<int> ports;
+    for (const std::string &path : paths) {
+        int port = reactor.openPort(path, baud);
+        if (port < 0) {
+            std::fprintf(stderr, "fleet: %s: %s\n", path.c_str(), std::strerror(errno));
+            return 1;
+        }
+        ports.push_back(port);
+    }
+    if (!reactor.start()) {
+        std::perror("fleet: epoll");
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    const std::vector<uint8_t> query(QUERY_STATUS_FRAME.begin(), QUERY_STATUS_FRAME.end());
+    Clock::time_point begin = Clock::now();
+    Clock::time_point nextQuery = begin;
+    Clock::time_point nextReport = begin + std::chrono::seconds(1);
+    double cpuBegin = cpuSeconds();
+    double cpuLast = cpuBegin;
+    uint64_t completedLast = 0;
+
+    while (running) {
+        Clock::time_point now = Clock::now();
+        if (duration > 0 && now - begin >= std::chrono::duration<double>(duration)) {
+            break;
+        }
+
+        if (queryMs > 0 && now >= nextQuery) {
+            for (int port : ports) {
+                reactor.enqueue(port, query, "查询状态", CommandPriority::Background);
+            }
+            nextQuery += std::chrono::milliseconds(queryMs);
+        }
+
+        if (now >= nextReport) {
+            double cpu = cpuSeconds();
+            uint64_t completed = counters.completed.load();
+            std::printf("t=%.0f ports=%zu completed/s=%llu failed=%llu cpu=%.1f%%\n",
+                        std::chrono::duration<double>(now - begin).count(), reactor.portCount(),
+                        static_cast<unsigned long long>(completed - completedLast),
+                        static_cast<unsigned long long>(counters.failed.load()), (cpu - cpuLast) * 100.0);
+            std::fflush(stdout);
+            cpuLast = cpu;
+            completedLast = completed;
+            nextReport += std::chrono::seconds(1);
+        }
+
+        Clock::time_point wake = nextReport;
+        if (queryMs > 0) {
+            wake = std::min(wake, nextQuery);
+        }
+        std::this_thread::sleep_until(wake);
+    }
+
+    reactor.stop();
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    const SerialReactor::Stats &stats = reactor.stats();
+    std::printf("elapsed=%.3f\n", elapsed);
+    std::printf("ports=%zu\n", ports.size());
+    std::printf("transmitted=%llu\n", static_cast<unsigned long long>(counters.transmitted.load()));
+    std::printf("retransmitted=%llu\n", static_cast<unsigned long long>(counters.retransmitted.load()));
+    std::printf("completed=%llu\n", static_cast<unsigned long long>(counters.completed.load()));
+    std::printf("failed=%llu\n", static_cast<unsigned long long>(counters.failed.load()));
+    std::printf("parse_errors=%llu\n", static_cast<unsigned long long>(counters.parseErrors.load()));
+    std::printf("port_errors=%llu\n", static_cast<unsigned long long>(counters.portErrors.load()));
+    std::printf("frames=%llu\n", static_cast<unsigned long long>(stats.frames.load()));
+    std::printf("wakeups=%llu\n", static_cast<unsigned long long>(stats.wakeups.load()));
+    std::printf("bytes_in=%llu\n", static_cast<unsigned long long>(stats.bytesIn.load()));
+    std::printf("bytes_out=%llu\n", static_cast<unsigned long long>(stats.bytesOut.load()));
+    std::printf("cpu_percent=%.2f\n", elapsed > 0 ? (cpuSeconds() - cpuBegin) / elapsed * 100.0 : 0.0);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// 抓包回放工具：把抓包文件中的接收数据送入帧解析器，统计解析速度和解码错误
+//
+// 用法: replay <capture.ecap> [--speed N|max] [--port ID] [--tx] [--verbose] [--simd scalar|sse2|avx2]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bytescan.h"
+#include "capture.h"
+#include "replay.h"
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: replay <capture.ecap> [--speed N|max] [--port ID] [--tx] [--verbose] [--simd scalar|sse2|avx2]\n");
+}
+
+static const char *errorName(ParseError error)
+{
+    switch (error) {
+        case ParseError::NoHeader:         return "no-header";
+        case ParseError::InvalidLength:    return "invalid-length";
+        case ParseError::ChecksumMismatch: return "checksum";
+    }
+    return "unknown";
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path;
+    ReplayOptions options;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            ++i;
+            options.speed = std::strcmp(argv[i], "max") == 0 ? 0 : std::atof(argv[i]);
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.portId = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tx") == 0) {
+            options.includeTx = true;
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (std::strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            SimdLevel level;
+            if (!simdLevelFromName(argv[++i], level)) {
+                usage();
+                return 2;
+            }
+            if (!setSimdLevel(level)) {
+                std::fprintf(stderr, "replay: %s is not supported by this CPU\n", argv[i]);
+                return 1;
+            }
+        } else if (argv[i][0] != '-' && path.empty()) {
+            path = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (path.empty() || options.speed < 0) {
+        usage();
+        return 2;
+    }
+
+    CaptureReader reader;
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "replay: %s: %s\n", path.c_str(), reader.errorString().c_str());
+        return 1;
+    }
+
+    ReplayEngine engine(reader);
+    if (verbose) {
+        engine.setFrameHandler([](uint8_t portId, const uint8_t *frame, size_t len) {
+            std::printf("port %u frame:", portId);
+            for (size_t i = 0; i < len; ++i) {
+                std::printf(" %02X", frame[i]);
+            }
+            std::printf("\n");
+        });
+    }
+    engine.setErrorHandler([](uint8_t portId, ParseError error, const uint8_t *frame, size_t len) {
+        std::printf("port %u error: %s", portId, errorName(error));
+        for (size_t i = 0; i < len; ++i) {
+            std::printf(" %02X", frame[i]);
+        }
+        std::printf("\n");
+    });
+
+    ReplayReport report = engine.run(options);
+
+    std::printf("simd=%s\n", simdLevelName(simdLevel()));
+    std::printf("records=%llu\n", static_cast<unsigned long long>(report.records));
+    std::printf("bytes=%llu\n", static_cast<unsigned long long>(report.parser.bytes));
+    std::printf("frames=%llu\n", static_cast<unsigned long long>(report.parser.frames));
+    std::printf("checksum_errors=%llu\n", static_cast<unsigned long long>(report.parser.checksumErrors));
+    std::printf("length_errors=%llu\n", static_cast<unsigned long long>(report.parser.lengthErrors));
+    std::printf("discarded_bytes=%llu\n", static_cast<unsigned long long>(report.parser.discardedBytes));
+    std::printf("overflow_bytes=%llu\n", static_cast<unsigned long long>(report.parser.overflowBytes));
+    std::printf("truncated=%d\n", report.truncated ? 1 : 0);
+    std::printf("elapsed_s=%.6f\n", report.elapsedSeconds);
+    std::printf("frames_per_s=%.1f\n", report.framesPerSecond);
+    std::printf("bytes_per_s=%.1f\n", report.bytesPerSecond);
+    for (const auto &entry : report.frameTypes) {
+        std::printf("frame_type cmd=0x%02X dp=0x%02X count=%llu\n",
+                    entry.first >> 8, entry.first & 0xFF, static_cast<unsigned long long>(entry.second));
+    }
+    return 0;
+}
@@ -0,0 +1,10 @@
+# 抓包回放工具（命令行，不依赖 Qt）
+TEMPLATE = app
+TARGET = replay
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../../core/core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,420 @@
+// 下位机模拟器：打开伪终端，按 80C51 固件的协议应答，界面程序可以像真实串口一样连接
+//
+// 用法: simulator [--link PATH] [--type A|F] [--latency MS] [--jitter MS] [--baud N]
+//                  [--drop RATE] [--corrupt RATE] [--seed N] [--verbose]
+//
+//   --link     在 PATH 创建指向伪终端从设备的符号链接（如 /tmp/ttyELV0）
+//   --type     下位机类型，A 型通道为 A~D，F 型为 F0~F9（默认 A）
+//   --latency  收到完整请求后到开始应答的延时（毫秒，默认 10）
+//   --jitter   延时的随机抖动范围 ±MS（默认 0）
+//   --baud     模拟线路速率，按 8N1 每字节 10 位计算收发耗时；0 表示不限速（默认 9600）
+//   --drop     应答丢失概率 0~1
+//   --corrupt  应答中随机改写一个字节的概率 0~1
+//
+// 退出（Ctrl+C）时输出 key=value 格式的统计
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "frameparser.h"
+#include "protocol.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const uint8_t MCU_VERSION = 0x03;    // 下位机应答的版本号
+
+struct SimOptions {
+    std::string linkPath;
+    uint8_t afSelect = static_cast<uint8_t>(AFSelectValue::AFSelect_A);
+    double latencyMs = 10;
+    double jitterMs = 0;
+    int baud = 9600;
+    double dropRate = 0;
+    double corruptRate = 0;
+    unsigned seed = 1;
+    bool verbose = false;
+};
+
+struct SimStats {
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t dropped = 0;
+    uint64_t corrupted = 0;
+    uint64_t ignored = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+static volatile std::sig_atomic_t running = 1;
+
+static void onSignal(int)
+{
+    running = 0;
+}
+
+// 组帧：55 AA | 版本 | 命令字 | 长度 | 数据 | 校验和
+static std::vector<uint8_t> makeResponse(uint8_t command, const uint8_t *payload, size_t len)
+{
+    std::vector<uint8_t> frame(FRAMEOVERHEAD + len);
+    frame[0] = (FRAME_HEADER >> 8) & 0xFF;
+    frame[1] = FRAME_HEADER & 0xFF;
+    frame[2] = MCU_VERSION;
+    frame[3] = command;
+    frame[4] = (len >> 8) & 0xFF;
+    frame[5] = len & 0xFF;
+    if (len > 0) {
+        std::memcpy(&frame[6], payload, len);
+    }
+    frame.back() = FrameParser::checksum(frame.data(), frame.size() - 1);
+    return frame;
+}
+
+// 下位机状态与协议处理
+class DeviceModel {
+public:
+    explicit DeviceModel(uint8_t afSelect)
+    {
+        status.offOn = static_cast<uint8_t>(SwitchValue::SWITCH_OFF);
+        status.maxChannel.set(99);
+        status.channel.set(1);
+        status.positionControl = static_cast<uint8_t>(DevCtrlValue::DevCtrl_STOP);
+        status.afSelect = afSelect;
+    }
+
+    // 处理一帧请求，需要应答时返回 true
+    bool handle(const uint8_t *frame, size_t len, std::vector<uint8_t> &response)
+    {
+        const uint8_t *data = frame + 6;
+        size_t dataLength = len - FRAMEOVERHEAD;
+
+        switch (frame[3]) {
+            case HEARTBEAT: {
+                // 首次心跳应答 0x00，之后为 0x01
+                uint8_t value = firstHeartbeat ? 0x00 : 0x01;
+                firstHeartbeat = false;
+                response = makeResponse(HEARTBEAT, &value, 1);
+                return true;
+            }
+            case QUERY_STATUS:
+                response = report(DPType::ALL_STATUS);
+                return true;
+            case DEVICE_CONTROL:
+                return control(data, dataLength, response);
+            default:
+                return false;
+        }
+    }
+
+private:
+    // 设备控制：DP ID + 数据类型 + 功能长度 + 功能数据，长度与 DP 表不符时不应答
+    bool control(const uint8_t *data, size_t len, std::vector<uint8_t> &response)
+    {
+        if (len < offset_BASE) {
+            return false;
+        }
+        const DPDescriptor *dp = findDP(data[0]);
+        size_t valueLength = static_cast<size_t>(data[2] << 8 | data[3]);
+        if (!dp || valueLength != dp->width || len < offset_BASE + valueLength) {
+            return false;
+        }
+
+        uint8_t *raw = reinterpret_cast<uint8_t*>(&status);
+        if (dp->fields) {
+            std::memcpy(raw, data + offset_BASE, sizeof(status));
+        } else {
+            for (const DPField &field : ALL_STATUS_FIELDS) {
+                if (field.id == dp->id) {
+                    std::memcpy(raw + field.offset, data + offset_BASE, dp->width);
+                }
+            }
+        }
+
+        response = report(dp->id);
+        return true;
+    }
+
+    // 上报一个 DP 的当前值
+    std::vector<uint8_t> report(DPType id)
+    {
+        const DPDescriptor &dp = dpDescriptor(id);
+        uint8_t payload[FRAMEMAXDATALENGTH] = {
+            static_cast<uint8_t>(dp.id), static_cast<uint8_t>(dp.dataType), 0x00, dp.width
+        };
+
+        const uint8_t *raw = reinterpret_cast<const uint8_t*>(&status);
+        if (dp.fields) {
+            std::memcpy(payload + offset_BASE, raw, sizeof(status));
+        } else {
+            for (const DPField &field : ALL_STATUS_FIELDS) {
+                if (field.id == dp.id) {
+                    std::memcpy(payload + offset_BASE, raw + field.offset, dp.width);
+                }
+            }
+        }
+        return makeResponse(MCU_RESPONSE, payload, offset_BASE + dp.width);
+    }
+
+    AllStatus status = {};
+    bool firstHeartbeat = true;
+};
+
+// 模拟线路：应答按到期时间排队，再按波特率逐字节写出
+class SimLink {
+public:
+    SimLink(int fd, const SimOptions &options, SimStats &stats)
+        : fd(fd), options(options), stats(stats), rng(options.seed) {
+        if (options.baud > 0) {
+            byteTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(10.0 / options.baud));
+        }
+    }
+
+    Clock::duration wireTime(size_t bytes) const { return byteTime * static_cast<int>(bytes); }
+
+    // 请求在 received 时刻完整到达，应答在延时和抖动之后开始发送
+    void schedule(std::vector<uint8_t> response, Clock::time_point received)
+    {
+        double delayMs = options.latencyMs;
+        if (options.jitterMs > 0) {
+            delayMs += std::uniform_real_distribution<double>(-options.jitterMs, options.jitterMs)(rng);
+        }
+        Clock::time_point due = received + std::chrono::duration_cast<Clock::duration>(
+                                               std::chrono::duration<double, std::milli>(std::max(0.0, delayMs)));
+        // 下位机按请求顺序应答
+        if (!pending.empty() && due < pending.back().due) {
+            due = pending.back().due;
+        }
+        pending.push_back({due, std::move(response), 0});
+    }
+
+    // 写出到期的字节，返回下一次需要唤醒的时刻
+    Clock::time_point service(Clock::time_point now)
+    {
+        while (!pending.empty() && pending.front().due <= now && !transmitting) {
+            Frame frame = std::move(pending.front());
+            pending.pop_front();
+            if (chance(options.dropRate)) {
+                stats.dropped++;
+                if (options.verbose) {
+                    std::printf("drop response\n");
+                }
+                continue;
+            }
+            if (chance(options.corruptRate)) {
+                size_t index = std::uniform_int_distribution<size_t>(0, frame.bytes.size() - 1)(rng);
+                frame.bytes[index] ^= static_cast<uint8_t>(std::uniform_int_distribution<int>(1, 255)(rng));
+                stats.corrupted++;
+            }
+            frame.due = std::max(frame.due, lineFree);
+            current = std::move(frame);
+            transmitting = true;
+        }
+
+        if (transmitting) {
+            size_t due = current.bytes.size();
+            if (byteTime.count() > 0) {
+                auto elapsed = now - current.due;
+                due = elapsed < Clock::duration::zero() ? 0 : std::min(due, static_cast<size_t>(elapsed / byteTime) + 1);
+            }
+            while (current.written < due) {
+                ssize_t n = ::write(fd, current.bytes.data() + current.written, due - current.written);
+                if (n <= 0) {
+                    break;
+                }
+                current.written += n;
+                stats.bytesOut += n;
+            }
+            if (current.written >= current.bytes.size()) {
+                lineFree = current.due + wireTime(current.bytes.size());
+                transmitting = false;
+                stats.responses++;
+                return service(now);
+            }
+            return current.due + wireTime(current.written);
+        }
+
+        return pending.empty() ? Clock::time_point::max() : pending.front().due;
+    }
+
+private:
+    struct Frame {
+        Clock::time_point due;
+        std::vector<uint8_t> bytes;
+        size_t written;
+    };
+
+    bool chance(double rate)
+    {
+        return rate > 0 && std::uniform_real_distribution<double>(0, 1)(rng) < rate;
+    }
+
+    int fd;
+    const SimOptions &options;
+    SimStats &stats;
+    std::mt19937 rng;
+    Clock::duration byteTime = Clock::duration::zero();
+    std::deque<Frame> pending;
+    Frame current;
+    bool transmitting = false;
+    Clock::time_point lineFree;
+};
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: simulator [--link PATH] [--type A|F] [--latency MS] [--jitter MS] [--baud N]\n"
+                         "                 [--drop RATE] [--corrupt RATE] [--seed N] [--verbose]\n");
+}
+
+static void printFrame(const char *prefix, const uint8_t *frame, size_t len)
+{
+    std::printf("%s", prefix);
+    for (size_t i = 0; i < len; ++i) {
+        std::printf(" %02X", frame[i]);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    SimOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--link") == 0 && hasValue) {
+            options.linkPath = argv[++i];
+        } else if (std::strcmp(arg, "--type") == 0 && hasValue) {
+            ++i;
+            if (std::strcmp(argv[i], "A") == 0) {
+                options.afSelect = static_cast<uint8_t>(AFSelectValue::AFSelect_A);
+            } else if (std::strcmp(argv[i], "F") == 0) {
+                options.afSelect = static_cast<uint8_t>(AFSelectValue::AFSelect_F);
+            } else {
+                usage();
+                return 2;
+            }
+        } else if (std::strcmp(arg, "--latency") == 0 && hasValue) {
+            options.latencyMs = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--jitter") == 0 && hasValue) {
+            options.jitterMs = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--baud") == 0 && hasValue) {
+            options.baud = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--drop") == 0 && hasValue) {
+            options.dropRate = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--corrupt") == 0 && hasValue) {
+            options.corruptRate = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--verbose") == 0) {
+            options.verbose = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    // 伪终端设为原始模式，避免行规程改写或回显协议字节
+    int master = -1;
+    int slave = -1;
+    char slaveName[256];
+    struct termios tio;
+    std::memset(&tio, 0, sizeof(tio));
+    cfmakeraw(&tio);
+    if (openpty(&master, &slave, slaveName, &tio, nullptr) != 0) {
+        std::perror("simulator: openpty");
+        return 1;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if (!options.linkPath.empty()) {
+        unlink(options.linkPath.c_str());
+        if (symlink(slaveName, options.linkPath.c_str()) != 0) {
+            std::perror("simulator: symlink");
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::printf("port=%s\n", slaveName);
+    if (!options.linkPath.empty()) {
+        std::printf("link=%s\n", options.linkPath.c_str());
+    }
+    std::fflush(stdout);
+
+    SimStats stats;
+    DeviceModel device(options.afSelect);
+    SimLink link(master, options, stats);
+    FrameParser parser;
+    std::vector<uint8_t> response;
+
+    parser.setFrameHandler([&](const uint8_t *frame, size_t len) {
+        stats.requests++;
+        if (options.verbose) {
+            printFrame("request:", frame, len);
+        }
+        if (device.handle(frame, len, response)) {
+            // 请求的最后一个字节在线路上到达后才开始处理
+            link.schedule(response, Clock::now() + link.wireTime(len));
+        } else {
+            stats.ignored++;
+        }
+    });
+
+    uint8_t buffer[4096];
+    Clock::time_point wake = Clock::time_point::max();
+    while (running) {
+        int timeout = -1;
+        if (wake != Clock::time_point::max()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(wake - Clock::now()).count();
+            timeout = remaining <= 0 ? 0 : static_cast<int>((remaining + 999) / 1000);
+        }
+
+        struct pollfd pfd = {master, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0 && errno != EINTR) {
+            std::perror("simulator: poll");
+            break;
+        }
+
+        if (ready > 0 && (pfd.revents & POLLIN)) {
+            ssize_t n;
+            while ((n = read(master, buffer, sizeof(buffer))) > 0) {
+                stats.bytesIn += n;
+                parser.feed(buffer, static_cast<size_t>(n));
+            }
+        }
+
+        wake = link.service(Clock::now());
+    }
+
+    if (!options.linkPath.empty()) {
+        unlink(options.linkPath.c_str());
+    }
+    close(slave);
+    close(master);
+
+    const FrameParser::Stats &parserStats = parser.stats();
+    std::printf("requests=%llu\n", static_cast<unsigned long long>(stats.requests));
+    std::printf("responses=%llu\n", static_cast<unsigned long long>(stats.responses));
+    std::printf("ignored=%llu\n", static_cast<unsigned long long>(stats.ignored));
+    std::printf("dropped=%llu\n", static_cast<unsigned long long>(stats.dropped));
+    std::printf("corrupted=%llu\n", static_cast<unsigned long long>(stats.corrupted));
+    std::printf("bytes_in=%llu\n", static_cast<unsigned long long>(stats.bytesIn));
+    std::printf("bytes_out=%llu\n", static_cast<unsigned long long>(stats.bytesOut));
+    std::printf("checksum_errors=%llu\n", static_cast<unsigned long long>(parserStats.checksumErrors));
+    return 0;
+}
@@ -0,0 +1,12 @@
+# 下位机模拟器（命令行，Linux 伪终端，不依赖 Qt）
+TEMPLATE = app
+TARGET = simulator
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../../core/core.pri)
+
+LIBS += -lutil
+
+SOURCES += \
+    main.cpp
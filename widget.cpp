@@ -4,15 +4,29 @@
 Widget::Widget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::Widget),
-    serialPort(new QSerialPort(this)),
-    receiverThread(new QThread(this)),
-    sendThread(new QThread(this)),
-    isReceiving(false),
-    heartbeatThread(new QThread(this)),
-    heartbeatTimer(new QTimer(this)),
-    responseTimeoutTimer(new QTimer(this))
+    sessions(new SessionManager(&wireCapture, this)),
+    session(sessions->createSession()),
+    modeExecutor(new ModeExecutor(this)),
+    logModel(new LogModel(LOGMAXLINES, this))
 {
     ui->setupUi(this);
+
+    // 日志视图只渲染可见行，追加的日志按刷新间隔合并后滚动到底部
+    ui->logViewer->setModel(logModel);
+    connect(logModel, &LogModel::flushed, ui->logViewer, &QListView::scrollToBottom);
+
+    // 日志同时由后台线程异步写入文件
+    QString logDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/Elevator/logs";
+    if (!QDir().mkpath(logDir) || !logSink.start(QDir::toNativeSeparators(logDir).toStdString())) {
+        appendLog("Warning: 无法创建日志文件，日志仅显示在界面中：" + logDir, Qt::red);
+    }
+
+    // 串口收发的原始字节写入二进制抓包文件
+    QString captureDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/Elevator/capture";
+    QString capturePath = captureDir + QDateTime::currentDateTime().toString("/'capture_'yyyyMMdd_HHmmss'.ecap'");
+    if (!QDir().mkpath(captureDir) || !wireCapture.open(QDir::toNativeSeparators(capturePath).toStdString())) {
+        appendLog("Warning: 无法创建抓包文件：" + capturePath, Qt::red);
+    }
     this->setWindowTitle("升降器控制平台(测试版 V6.0)");
 
     // 设置窗口标志，禁用最大化按钮和调整大小功能
@@ -24,17 +38,52 @@ Widget::Widget(QWidget *parent)
     // 获取并遍历所有可用的串口
     scan_serial();
 
-    connect(serialPort, &QSerialPort::readyRead, this, &Widget::readSerialData);
+    // 串口下拉框可编辑，未扫描到串口时也可以输入端口名
+    connect(ui->serialCb, &QComboBox::editTextChanged, this, [this](const QString &text) {
+        if (ui->openSerialBt->text() == "打开串口") {
+            ui->openSerialBt->setEnabled(!text.trimmed().isEmpty());
+        }
+    });
 
-    setEnabledMy(false);
+    // 波特率：自动识别或固定速率
+    ui->baudRateCb->addItem("自动", 0);
+    for (qint32 rate : BAUDRATE_CANDIDATES) {
+        ui->baudRateCb->addItem(QString::number(rate), rate);
+    }
 
-    // 连接响应超时定时器的 timeout 信号到 onResponseTimeout 槽函数
-    connect(responseTimeoutTimer, &QTimer::timeout, this, &Widget::onResponseTimeout);
-    // 设置响应超时定时器间隔
-    responseTimeoutTimer->setSingleShot(true);  // 设置为单次定时器
+    setEnabledMy(false);
 
-    // 启动心跳检测线程
-    startHeartbeatThread();
+    // 界面操作一个会话，会话的串口线程与界面之间只通过排队信号通信
+    connect(session, &DeviceSession::logMessage, this, &Widget::appendLog);
+    connect(session, &DeviceSession::portOpened, this, &Widget::onPortOpened);
+    connect(session, &DeviceSession::baudRateDetected, this, [this](qint32 baudRate) {
+        saveBaudRate(session->portName(), baudRate);
+    });
+    connect(session, &DeviceSession::frameReceived, this, &Widget::onFrameReceived);
+    connect(session, &DeviceSession::responseTimeout, this, &Widget::onResponseTimeout);
+    connect(session, &DeviceSession::heartbeatTimeout, this, [this]() { setEnabledMy(false); });
+
+    // 模式执行器的进度与结果
+    connect(modeExecutor, &ModeExecutor::progress, this, [this](quint32 loop, int step, int) {
+        if (step == 0) {
+            appendLog(QString("模式第 %1 轮开始").arg(loop + 1), Qt::gray);
+        }
+    });
+    connect(modeExecutor, &ModeExecutor::stepLate, this, [this](quint32 loop, int row, double lateMs) {
+        appendLog(QString("Warning: 第%1轮 Row %2 迟到 %3 ms，后续步骤按时间线补偿.")
+                      .arg(loop + 1).arg(row).arg(lateMs, 0, 'f', 1), Qt::darkYellow);
+    });
+    connect(modeExecutor, &ModeExecutor::finished, this, [this](bool completed, const ModeReport &report) {
+        appendLog(QString("时间线统计：%1 步，迟到 %2 步，跳过 %3 步，最大迟到 %4 ms，平均迟到 %5 ms")
+                      .arg(report.steps).arg(report.lateSteps).arg(report.skippedSteps)
+                      .arg(report.maxLateMs, 0, 'f', 1).arg(report.meanLateMs, 0, 'f', 2), Qt::gray);
+        if (completed) {
+            appendLog("发送模式结束。", Qt::gray);
+            setColor();
+        } else {
+            appendLog("发送操作模式已被停止。", Qt::gray);
+        }
+    });
 
     // ui->openBt->setText("开关");
     setBottonImage(ui->openBt, ":/icons/power_black.png");
@@ -60,37 +109,13 @@ Widget::Widget(QWidget *parent)
 Widget::~Widget()
 {
     // 模式复位
-    stopRequested = true;
-    emit stopLoopSignal();
+    modeExecutor->stop();
     setColor();
     sendReset();
-    
-    QEventLoop loop;
-    QTimer::singleShot(RESPONSETIMEOUTTIMESET * 3, &loop, &QEventLoop::quit);
-    loop.exec();
-
-    if (serialPort->isOpen()) {
-        QThread::msleep(RESPONSETIMEOUTTIMESET);
-        serialPort->close();
-    }
-    if (receiverThread->isRunning()) {
-        receiverThread->quit();
-        receiverThread->wait();
-        delete receiverThread;
-    }
-    if (heartbeatThread->isRunning()) {
-        heartbeatThread->quit();
-        heartbeatThread->wait();
-        delete heartbeatThread;
-    }
-    if (sendThread->isRunning()) {
-        sendThread->quit();
-        sendThread->wait();  // 等待线程退出
-        delete sendThread;   // 释放资源
-    }
-    // 停止并删除定时器
-    heartbeatTimer->stop();
-    responseTimeoutTimer->stop();
+
+    // 关闭全部会话并等待会话线程退出，之后才能释放抓包文件
+    // 串口关闭前会话线程先把复位指令发完并等待响应
+    sessions->clear();
     delete ui;
 }
 
@@ -103,17 +128,11 @@ void Widget::appendLog(const QString &text, const QColor &color) {
     // 格式化消息，加上时间戳
     QString formattedMessage = QString("[%1] %2").arg(currentTime, text);
 
-    // 设置颜色并追加消息到日志视图
-    QTextCharFormat fmt;
-    fmt.setForeground(color);
+    // 追加到日志模型，超出容量时丢弃最旧的行
+    logModel->append(formattedMessage, color);
 
-    // 使用 QTextCursor 设置格式
-    QTextCursor cursor = ui->logViewer->textCursor();
-    cursor.movePosition(QTextCursor::End);
-    cursor.insertText(formattedMessage + '\n', fmt);
-
-    // 确保滚动到最后
-    ui->logViewer->moveCursor(QTextCursor::End);
+    // 推入日志文件队列，不等待磁盘写入
+    logSink.write(formattedMessage.toStdString());
 }
 
 void Widget::setBottonImage(QPushButton* button, QString imagePath) {
@@ -147,7 +166,7 @@ void Widget::scan_serial()
             ui->serialCb->addItem(portDetail, info.portName());
         }
         else {
-            ui->serialCb->addItem(info.portName());
+            ui->serialCb->addItem(info.portName(), info.portName());
         }
 
         foundPorts.append(info.portName());
@@ -167,14 +186,32 @@ void Widget::scan_serial()
     }
 }
 
+static QString baudRateKey(const QString &portName)
+{
+    // 设备路径中的 / 会被 QSettings 当作分组分隔符
+    return "baudRate/" + QString(portName).replace('/', '_');
+}
+
+qint32 Widget::savedBaudRate(const QString &portName) const
+{
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "Elevator", "Elevator_control_platform");
+    return settings.value(baudRateKey(portName), 0).toInt();
+}
+
+void Widget::saveBaudRate(const QString &portName, qint32 baudRate)
+{
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "Elevator", "Elevator_control_platform");
+    settings.setValue(baudRateKey(portName), baudRate);
+}
+
 void Widget::setEnabledMy(bool flag)
 {
-//    ui->baundrateCb->setEnabled(!flag);
+    ui->baudRateCb->setEnabled(!flag);
     ui->btnSerialCheck->setEnabled(!flag);
     ui->serialCb->setEnabled(!flag);
 
     ui->label_1->setEnabled(!flag);
-//    ui->label_2->setEnabled(!flag);
+    ui->label_2->setEnabled(!flag);
     ui->label_3->setEnabled(flag);
     ui->label_4->setEnabled(flag);
     ui->label_5->setEnabled(flag);
@@ -197,115 +234,40 @@ void Widget::setEnabledMy(bool flag)
     ui->queryCb->setEnabled(flag);
 }
 
-void Widget::startHeartbeatThread()
-{
-    // 如果心跳线程已经在运行，直接返回，不重复启动
-    if (heartbeatThread->isRunning()) {
-        return;
-    }
-
-    // 如果定时器已经启动，直接返回，不重复启动
-    if (heartbeatTimer->isActive()) {
-        return;
-    }
-
-    // 将定时器设置为定期触发
-    heartbeatTimer->setInterval(HEARTBEATTIMESET); // 每隔秒发送一次心跳
-    connect(heartbeatTimer, &QTimer::timeout, this, &Widget::sendHeartbeat);
-
-    // 如果线程没有在运行，则启动线程
-    if (!heartbeatThread->isRunning()) {
-        // 启动心跳线程
-        heartbeatThread->start();
-    }
-
-    // 启动心跳定时器
-//    heartbeatTimer->start();
-}
-
-
-void Widget::sendHeartbeat()
-{
-    ProtocolFrame frame = createHeartbeatFrame();  // 创建心跳帧
-    waitingForHeartbeat = true;
-    sendFrame(frame, "发送心跳帧");  // 发送心跳帧
-}
-
-
 /*打开串口*/
 void Widget::on_openSerialBt_clicked()
 {
-    // 初始化串口属性，设置 端口号、波特率、数据位、停止位、奇偶校验位数
-    QRegularExpression re("COM\\d+");
-    serialPort->setPortName(re.match(ui->serialCb->currentText()).captured(0));
-    serialPort->setBaudRate(QSerialPort::Baud9600);
-    serialPort->setDataBits(QSerialPort::Data8);
-    serialPort->setStopBits(QSerialPort::OneStop);
-    serialPort->setParity(QSerialPort::NoParity);
-
-    // 根据初始化好的串口属性，打开串口
-    // 如果打开成功，反转打开按钮显示和功能。打开失败，无变化，并且弹出错误对话框。
+    // 打开成功后，反转打开按钮显示和功能（见 onPortOpened）。打开失败，无变化，并且弹出错误对话框。
     if(ui->openSerialBt->text() == "打开串口"){
-        if(serialPort->open(QIODevice::ReadWrite) == true){
-            ui->openSerialBt->setText("关闭串口");
-            // 让端口号下拉框不可选，避免误操作（选择功能不可用，控件背景为灰色）
-            //  ui->serialCb->setEnabled(false);
-            setEnabledMy(true);
-            appendLog("串口打开成功", Qt::green);
-
-            // 启动接收线程
-            // isReceiving = true;
-            receiverThread->start();
-
-            // 启动发送线程
-            sendThread->start();
-
-            // 恢复心跳检测线程
-            heartbeatTimer->start(); // 恢复定时器
-            selectSerial = true;
-            emit ui->queryCb->clicked();
-            selectSerial = false;
-            // stopRequested = false;
-        }else{
-            QMessageBox::critical(this, "错误提示", "串口打开失败！！！\r\n该串口可能被占用\r\n请选择正确的串口");
-            appendLog("串口打开失败", Qt::red);
+        // 串口在串口线程中打开：端口号、波特率、数据位、停止位、奇偶校验位数
+        // 列表中的串口取端口名，手动输入的名称按原样打开（如设备模拟器的 /dev/pts/N）
+        QString portName = ui->serialCb->currentText().trimmed();
+        int index = ui->serialCb->findText(portName);
+        if (index >= 0) {
+            portName = ui->serialCb->itemData(index).toString();
         }
+        // 自动识别时先尝试该端口上次识别出的速率
+        LineSettings settings;
+        settings.baudRate = ui->baudRateCb->currentData().toInt();
+        if (settings.baudRate == 0) {
+            settings.preferredBaudRate = savedBaudRate(portName);
+        }
+
+        ui->openSerialBt->setEnabled(false);
+        session->open(portName, settings);
     }else{
         // 模式复位
-        stopRequested = true;
-        emit stopLoopSignal();
+        modeExecutor->stop();
         setColor();
         sendReset();
 
         // ui->openBt->setText("开关");
         setBottonImage(ui->openBt, ":/icons/power_black.png");
         selectSerial = false;
-        isReceiving = false;
-        // 停止接收线程
-        if (receiverThread->isRunning()) {
-            receiverThread->quit();
-            receiverThread->wait();
-        }
-        if (heartbeatThread->isRunning()) {
-            heartbeatThread->quit();
-            heartbeatThread->wait();
-        }
-        if (sendThread->isRunning()) {
-            sendThread->quit();
-            sendThread->wait();  // 等待线程退出
-        }
-        // 停止并删除定时器
-        heartbeatTimer->stop();
-        responseTimeoutTimer->stop();
 
-        waitingForHeartbeat = false;
-        waitingForResponse = false;  // 重置等待标志
+        // 停止心跳，会话线程把复位指令发完后关闭串口
+        session->close();
 
-        serialPort->close();
-        if (serialPort->isOpen()) {
-            QThread::msleep(RESPONSETIMEOUTTIMESET);
-            serialPort->close();
-        }
         ui->openSerialBt->setText("打开串口");
         // 端口号下拉框恢复可选，避免误操作
         // ui->serialCb->setEnabled(true);
@@ -314,6 +276,26 @@ void Widget::on_openSerialBt_clicked()
     }
 }
 
+// 串口线程打开串口的结果
+void Widget::onPortOpened(bool ok)
+{
+    ui->openSerialBt->setEnabled(true);
+    if (ok) {
+        ui->openSerialBt->setText("关闭串口");
+        // 让端口号下拉框不可选，避免误操作（选择功能不可用，控件背景为灰色）
+        //  ui->serialCb->setEnabled(false);
+        setEnabledMy(true);
+        appendLog("串口打开成功", Qt::green);
+
+        selectSerial = true;
+        emit ui->queryCb->clicked();
+        selectSerial = false;
+    }else{
+        QMessageBox::critical(this, "错误提示", "串口打开失败！！！\r\n该串口可能被占用\r\n请选择正确的串口");
+        appendLog("串口打开失败", Qt::red);
+    }
+}
+
 //检测通讯端口槽函数
 void Widget::on_btnSerialCheck_clicked()
 {
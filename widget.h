@@ -14,9 +14,7 @@
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
-#include <QTextEdit>
-#include <QTextCursor>
-#include <QTextCharFormat>
+#include <QListView>
 #include <QColor>
 #include <QMouseEvent>
 #include <QFile>
@@ -36,12 +34,25 @@
 #include <QDebug>
 #include <QQueue>
 #include <QDir>
+#include <QSettings>
 
 
 #include "protocol.h"
+#include "dpcodec.h"
+#include "devicesession.h"
+#include "logmodel.h"
+#include "logsink.h"
+#include "capture.h"
+#include "modeprogram.h"
+#include "modeexecutor.h"
 
 using namespace std;
 
+// 按 QString 匹配名称表中的名称
+inline auto nameEquals(const QString &text) {
+    return [&text](const char *name) { return text == QLatin1String(name); };
+}
+
 
 
 QT_BEGIN_NAMESPACE
@@ -61,32 +72,45 @@ public:
     bool eventFilter(QObject *watched, QEvent *event);
     void appendLog(const QString &text, const QColor &color = Qt::black);
 
-    // 添加新的成员函数用于发送串口数据
-    void sendNextCommand();
-    void sendSerialData(const QByteArray &data, const QString &str_log); 
-    void sendFrame(const ProtocolFrame& frame, const QString &str_log);
-
-    // 添加新的成员函数用于读取串口数据
-    void readSerialData();  
-    void receiveFrames(std::vector<uint8_t>& buffer);
+    // 发送串口数据（交给串口线程排队发送），STOP、关机以 Safety 发送，查询以 Background 发送
+    void sendSerialData(const QByteArray &data, const QString &str_log,
+                        CommandPriority priority = CommandPriority::Interactive);
+    void sendFrame(const ProtocolFrame& frame, const QString &str_log,
+                   CommandPriority priority = CommandPriority::Interactive);
+    // 发送已编码的帧字节
+    template <size_t N>
+    void sendFrame(const std::array<uint8_t, N> &frame, const QString &str_log,
+                   CommandPriority priority = CommandPriority::Interactive) {
+        sendSerialData(QByteArray(reinterpret_cast<const char*>(frame.data()), N), str_log, priority);
+    }
+    // 发送编译期生成的固定帧，直接引用静态存储的字节，不复制
+    template <size_t N>
+    void sendStaticFrame(const std::array<uint8_t, N> &frame, const QString &str_log,
+                         CommandPriority priority = CommandPriority::Interactive) {
+        sendSerialData(QByteArray::fromRawData(reinterpret_cast<const char*>(frame.data()), N), str_log, priority);
+    }
+
+    // 处理串口线程解析出的响应帧
     void heartbeatHandle(std::vector<uint8_t>& data);
     void receiveHandle(std::vector<uint8_t>& data);
 
+    void dispatchDP(const DPDescriptor &dp, const uint8_t *value);
+    QString dpText(DPType id, uint32_t value) const;
+
     // 处理各种状态
-    void handle_OFF_ON(uint8_t func_val);
-    void handle_ACCESS_SELECT(uint8_t func_val);
-    void handle_MAXCHANNEL(uint16_t func_val);
-    void handle_CHANNEL(uint16_t func_val);
-    void handle_POSITION_CONTROL(uint8_t func_val);
-    void handle_A_F_SELECT(uint8_t func_val);
+    void handle_OFF_ON(uint32_t func_val);
+    void handle_ACCESS_SELECT(uint32_t func_val);
+    void handle_MAXCHANNEL(uint32_t func_val);
+    void handle_CHANNEL(uint32_t func_val);
+    void handle_POSITION_CONTROL(uint32_t func_val);
+    void handle_A_F_SELECT(uint32_t func_val);
 
     void scan_serial();
+    // 各端口上次识别出的波特率，保存在用户配置中
+    qint32 savedBaudRate(const QString &portName) const;
+    void saveBaudRate(const QString &portName, qint32 baudRate);
     void setEnabledMy(bool flag);
 
-    // 心跳线程
-    void startHeartbeatThread();
-    void sendHeartbeat();
-
     // 复位
     void sendReset();
 
@@ -95,16 +119,10 @@ public:
     void setBottonImage(QPushButton* width, QString imagePath);
 
 
-    uint8_t A_F_Flag = 0x11;
-    bool switchStatus = false;
-
-    int maxChannelNumber = 0;
-    int channelNumber = 0;
-
-    bool stopRequested = true;
-
-signals:
-    void stopLoopSignal();
+    // 当前会话的界面显示状态
+    DeviceState &state() { return session->state(); }
+    const DeviceState &state() const { return session->state(); }
+    DeviceSession *currentSession() const { return session; }
 
 private slots:
     void on_openSerialBt_clicked();
@@ -130,6 +148,8 @@ private slots:
     void on_queryCb_clicked();
 
     void onResponseTimeout();  // 响应超时槽函数
+    void onPortOpened(bool ok);
+    void onFrameReceived(quint8 command, const QByteArray &frameData);
 
     void on_maxChannelSetCb_returnPressed();
 
@@ -140,31 +160,17 @@ private slots:
 
 private:
     Ui::Widget *ui;
-    QSerialPort *serialPort;//定义串口指针
-
-    QThread *receiverThread;
-    QThread *sendThread; 
-    bool isReceiving; // 标记接收状态
-
-    QMutex serialMutex;  // 定义串口通信的互斥锁
+    SessionManager *sessions;    // 设备会话：每个会话的收发、心跳、超时都在各自的线程中运行
+    DeviceSession *session;      // 界面当前操作的会话
+    ModeExecutor *modeExecutor;  // 模式执行器：在独立线程中按时间线发送模式步骤
 
-    QThread *heartbeatThread;  // 新增心跳检测线程
-    QTimer *heartbeatTimer;    // 心跳定时器
-    bool waitingForHeartbeat;  // 等待心跳响应标志
-
-    bool waitingForResponse = false;  // 等待响应标志
-    QByteArray lastSentData;  // 记录上次发送的数据
-    QTimer *responseTimeoutTimer;  // 响应超时定时器
+    LogModel *logModel;          // 日志模型（有界环形缓冲区）
+    LogSink logSink;             // 日志文件（后台线程批量写入）
+    CaptureWriter wireCapture;   // 串口收发抓包文件
 
     bool accessRev = false;      // accessRev为false时正在处理接收数据，此时禁止发送通道数据
     bool serialCount = false;
     bool selectSerial = false;
-
-    QMutex sendMutex;  // 定义串口通信的互斥锁
-
-    // 添加队列和控制标志
-    QQueue<QPair<QByteArray, QString>> commandQueue;
-    bool isSending = false;  // 用来标记当前是否正在发送指令
 };
 
 
@@ -178,11 +184,12 @@ public:
     ~TableEditor();
 
     void printTableDataToLog(Widget *logWidget);
-    void sendTableData(Widget *logWidget);
     void loadTableData();
 
     void saveTableData();
     bool validateTableData(Widget *logWidget);
+    // 把表格编译为模式程序，失败时返回 false 并记录出错行
+    bool compileTableData(Widget *logWidget, ModeProgram &program);
 
 private slots:
     void addRow();